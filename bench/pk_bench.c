@@ -0,0 +1,1077 @@
+/**
+ * @file pk_bench.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Host benchmark suite
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Runs every pk_* kernel on deterministic synthetic ECG/PPG/RSP/IMU/RR data at
+ * several lengths and sample rates. Emits one JSON object per line:
+ * {"func": ..., "backend": ..., "signal": ..., "fs": ..., "len": ...,
+ *  "ns_per_sample": ..., "samples_per_s": ..., "scratch_bytes": ...}
+ *
+ * Usage: pk_bench [name-filter] [auto|cmsis|ref|avx2|neon]
+ *
+ * "pk_bench check [backend]" instead runs equivalence checks between paired
+ * kernels (q15 vs float ECG peaks) and exits non-zero on any mismatch.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "arm_math.h"
+
+#include "pk_dsp.h"
+#include "pk_math.h"
+#include "pk_filter.h"
+#include "pk_ecg.h"
+#include "pk_ppg.h"
+#include "pk_rsp.h"
+#include "pk_hrv.h"
+#include "pk_imu.h"
+#include "pk_interpolation.h"
+#include "pk_sort.h"
+#include "pk_transform.h"
+#include "pk_batch.h"
+
+#define BENCH_MAX_LEN (500 * 300)
+#define BENCH_MIN_NS (20000000ULL)
+#define BENCH_REPEATS (5)
+#define BENCH_BIQUAD_SECS (2)
+#define BENCH_BIQUAD_CHANNELS (8)
+#define BENCH_BATCH_RECORDS (8)
+#define BENCH_BATCH_THREADS (4)
+#define BENCH_Q15_SCALE (1000.0f) // ADC counts per signal unit for q15 cases
+
+typedef struct
+{
+    uint32_t len;
+    uint32_t fs;
+    float32_t *x; // Primary signal
+    q15_t *xq15; // Primary signal as raw ADC counts
+    float32_t *y; // Secondary signal (PPG2, IMU y)
+    float32_t *z; // Tertiary signal (IMU z)
+    float32_t *out1;
+    float32_t *out2;
+    float32_t *out3;
+    float32_t *scratch;
+    uint32_t *peaks;
+    uint32_t *rri;
+    uint32_t numPeaks; // Detected R peaks of ECG signal (peaks, rri, mask8)
+    uint32_t *labels; // Per-sample class labels of primary signal
+    uint8_t *mask8;
+    uint16_t *mask16;
+    float32_t biquadCoefs[5 * BENCH_BIQUAD_SECS];
+    float32_t biquadState[4 * BENCH_BIQUAD_SECS];
+    arm_biquad_casd_df1_inst_f32 biquad;
+} bench_data_t;
+
+typedef enum
+{
+    BENCH_SIG_ECG,
+    BENCH_SIG_PPG,
+    BENCH_SIG_RSP,
+    BENCH_SIG_IMU,
+    BENCH_SIG_RR,
+} bench_signal_t;
+
+typedef struct
+{
+    const char *name;
+    bench_signal_t signal;
+    uint32_t (*scratch)(bench_data_t *d); // Scratch bytes required
+    void (*run)(bench_data_t *d);
+} bench_case_t;
+
+static const char *benchSignalNames[] = {"ecg", "ppg", "rsp", "imu", "rr"};
+
+/******************************************************************************
+ * Synthetic data
+ ******************************************************************************/
+
+static uint32_t benchSeed = 1;
+
+static float32_t
+bench_rand(void)
+{
+    // Deterministic LCG in [-1, 1)
+    benchSeed = benchSeed * 1664525u + 1013904223u;
+    return (float32_t)(benchSeed >> 8) / (float32_t)(1u << 23) - 1.0f;
+}
+
+static float32_t
+bench_gauss(float32_t t, float32_t mu, float32_t sigma)
+{
+    return expf(-(t - mu) * (t - mu) / (2 * sigma * sigma));
+}
+
+static void
+bench_add_beats(float32_t *x, uint32_t len, uint32_t fs, float32_t meanRR, const float32_t *amp, const float32_t *off, const float32_t *width, uint32_t numWaves)
+{
+    float32_t t0 = 0.3f;
+    float32_t duration = (float32_t)len / fs;
+    while (t0 < duration)
+    {
+        for (size_t w = 0; w < numWaves; w++)
+        {
+            float32_t mu = t0 + off[w];
+            int32_t lo = (int32_t)((mu - 5 * width[w]) * fs);
+            int32_t hi = (int32_t)((mu + 5 * width[w]) * fs);
+            for (int32_t i = lo < 0 ? 0 : lo; i <= hi && i < (int32_t)len; i++)
+            {
+                x[i] += amp[w] * bench_gauss((float32_t)i / fs, mu, width[w]);
+            }
+        }
+        t0 += meanRR * (1.0f + 0.05f * bench_rand());
+    }
+}
+
+static void
+bench_synth_ecg(float32_t *x, uint32_t len, uint32_t fs)
+{
+    static const float32_t amp[] = {0.15f, -0.1f, 1.0f, -0.2f, 0.3f};
+    static const float32_t off[] = {-0.2f, -0.02f, 0.0f, 0.03f, 0.25f};
+    static const float32_t width[] = {0.025f, 0.008f, 0.012f, 0.01f, 0.04f};
+    for (size_t i = 0; i < len; i++)
+    {
+        x[i] = 0.1f * sinf(2 * PI * 0.25f * i / fs) + 0.01f * bench_rand();
+    }
+    bench_add_beats(x, len, fs, 0.8f, amp, off, width, 5);
+}
+
+static void
+bench_synth_ppg(float32_t *x, uint32_t len, uint32_t fs)
+{
+    static const float32_t amp[] = {1.0f, 0.3f, -0.4f};
+    static const float32_t off[] = {0.0f, 0.3f, 0.5f};
+    static const float32_t width[] = {0.08f, 0.08f, 0.2f};
+    for (size_t i = 0; i < len; i++)
+    {
+        x[i] = 0.02f * bench_rand();
+    }
+    bench_add_beats(x, len, fs, 0.85f, amp, off, width, 3);
+}
+
+static void
+bench_synth_rsp(float32_t *x, uint32_t len, uint32_t fs)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        float32_t t = (float32_t)i / fs;
+        x[i] = sinf(2 * PI * 0.25f * t + 0.3f * sinf(2 * PI * 0.01f * t)) + 0.05f * bench_rand();
+    }
+}
+
+static void
+bench_synth_imu(float32_t *x, float32_t *y, float32_t *z, uint32_t len, uint32_t fs)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        float32_t t = (float32_t)i / fs;
+        x[i] = 0.1f * sinf(2 * PI * 1.8f * t) + 0.02f * bench_rand();
+        y[i] = 0.2f + 0.05f * sinf(2 * PI * 0.9f * t) + 0.02f * bench_rand();
+        z[i] = 0.97f + 0.15f * sinf(2 * PI * 1.8f * t + 0.5f) + 0.02f * bench_rand();
+    }
+}
+
+static void
+bench_synth_rr(uint32_t *rri, uint8_t *mask, uint32_t len, uint32_t fs)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        float32_t rr = 0.8f + 0.05f * sinf(2 * PI * 0.25f * i * 0.8f) + 0.03f * bench_rand();
+        rri[i] = (uint32_t)(rr * fs);
+        mask[i] = (i % 50) == 49 ? 1 : 0;
+    }
+}
+
+static void
+bench_lowpass_biquad(float32_t *coefs, float32_t fc, float32_t fs)
+{
+    filter_design_f32_t design = {.family = PK_FILTER_BUTTERWORTH, .type = PK_FILTER_LOWPASS, .order = 2, .lowcut = fc, .sampleRate = fs};
+    pk_design_biquad_filter_f32(&design, coefs);
+}
+
+/******************************************************************************
+ * Bench cases
+ ******************************************************************************/
+
+static uint32_t
+bench_scratch_none(bench_data_t *d)
+{
+    return 0;
+}
+
+static void
+bench_run_mean(bench_data_t *d)
+{
+    pk_mean_f32(d->x, d->out1, d->len);
+}
+
+static void
+bench_run_std(bench_data_t *d)
+{
+    pk_std_f32(d->x, d->out1, d->len);
+}
+
+static void
+bench_run_rms(bench_data_t *d)
+{
+    pk_rms_f32(d->x, d->out1, d->len);
+}
+
+static void
+bench_run_gradient(bench_data_t *d)
+{
+    pk_gradient_f32(d->x, d->out1, d->len);
+}
+
+static void
+bench_run_smooth(bench_data_t *d)
+{
+    pk_smooth_signal_f32(d->x, d->out1, d->len, NULL, d->fs / 10 + 1);
+}
+
+static uint32_t
+bench_scratch_moving_average(bench_data_t *d)
+{
+    return (d->fs / 10 + 1) * sizeof(float32_t);
+}
+
+static void
+bench_run_moving_average(bench_data_t *d)
+{
+    moving_avg_f32_t ma = {.windowSize = d->fs / 10 + 1, .buffer = d->scratch};
+    pk_init_moving_average_f32(&ma);
+    pk_apply_moving_average_f32(&ma, d->x, d->out1, d->len);
+}
+
+static void
+bench_run_standardize(bench_data_t *d)
+{
+    pk_standardize_f32(d->x, d->out1, d->len, 1e-3f);
+}
+
+static void
+bench_run_biquad(bench_data_t *d)
+{
+    pk_apply_biquad_filter_f32(&d->biquad, d->x, d->out1, d->len);
+}
+
+static uint32_t
+bench_scratch_biquad_multi(bench_data_t *d)
+{
+    return 9 * BENCH_BIQUAD_SECS * BENCH_BIQUAD_CHANNELS * sizeof(float32_t);
+}
+
+static void
+bench_run_biquad_multi(bench_data_t *d)
+{
+    // Primary signal treated as BENCH_BIQUAD_CHANNELS interleaved channels
+    biquad_multi_f32_t ctx = {
+        .numChannels = BENCH_BIQUAD_CHANNELS,
+        .numStages = BENCH_BIQUAD_SECS,
+        .pCoeffs = d->scratch,
+        .pState = &d->scratch[5 * BENCH_BIQUAD_SECS * BENCH_BIQUAD_CHANNELS]};
+    pk_init_biquad_multi_f32(&ctx, d->biquadCoefs, 0);
+    pk_apply_biquad_multi_f32(&ctx, d->x, d->out1, d->len / BENCH_BIQUAD_CHANNELS);
+}
+
+static uint32_t
+bench_scratch_filtfilt(bench_data_t *d)
+{
+    return pk_biquad_filtfilt_state_size_f32(&d->biquad) * sizeof(float32_t);
+}
+
+static uint32_t
+bench_scratch_filtfilt_stream(bench_data_t *d)
+{
+    biquad_filtfilt_stream_f32_t ctx = {.numStages = d->biquad.numStages, .hopSize = d->fs / 2, .lookahead = 2 * d->fs};
+    return pk_biquad_filtfilt_stream_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_filtfilt_stream(bench_data_t *d)
+{
+    biquad_filtfilt_stream_f32_t ctx = {
+        .numStages = d->biquad.numStages, .coeffs = d->biquadCoefs, .hopSize = d->fs / 2, .lookahead = 2 * d->fs, .state = d->scratch};
+    pk_init_biquad_filtfilt_stream_f32(&ctx);
+    pk_apply_biquad_filtfilt_stream_f32(&ctx, d->x, d->out1, d->len);
+}
+
+static void
+bench_run_filtfilt(bench_data_t *d)
+{
+    pk_apply_biquad_filtfilt_f32(&d->biquad, d->x, d->out1, d->len, d->scratch);
+}
+
+static void
+bench_run_linear_downsample(bench_data_t *d)
+{
+    pk_linear_downsample_f32(d->x, d->len, d->fs, d->out1, d->len / 2, d->fs / 2);
+}
+
+static void
+bench_run_interp_resample(bench_data_t *d)
+{
+    // PPG to 64 Hz model rate
+    interp_resample_f32_t ctx = {.srcRate = d->fs, .dstRate = 64, .cubic = 0};
+    pk_init_interp_resample_f32(&ctx);
+    pk_interp_resample_f32(&ctx, d->x, d->out1, d->len);
+}
+
+static uint32_t
+bench_scratch_resample(bench_data_t *d)
+{
+    resample_f32_t ctx = {.upSample = 100, .downSample = d->fs, .tapsPerPhase = 16};
+    return (100 * 16 + pk_resample_state_size_f32(&ctx)) * sizeof(float32_t);
+}
+
+static void
+bench_run_resample(bench_data_t *d)
+{
+    // Resample to 100 Hz model rate
+    resample_f32_t ctx = {.upSample = 100, .downSample = d->fs, .tapsPerPhase = 16, .bank = d->scratch, .state = &d->scratch[100 * 16]};
+    pk_design_resample_bank_f32(d->scratch, ctx.upSample, ctx.downSample, ctx.tapsPerPhase);
+    pk_init_resample_f32(&ctx);
+    pk_resample_signal_f32(&ctx, d->x, d->out1, d->len);
+}
+
+static void
+bench_run_blackman(bench_data_t *d)
+{
+    pk_blackman_window_f32(d->out1, d->len);
+}
+
+static void
+bench_run_rescale(bench_data_t *d)
+{
+    rescale_signal_f32(d->x, -1.0f, 1.0f, 0.0f, 1.0f, d->len, 1, d->out1);
+}
+
+static void
+bench_run_quotient(bench_data_t *d)
+{
+    pk_quotient_filter_mask_u32(d->rri, d->mask8, d->len, 2, 0.7f, 1.3f);
+}
+
+static void
+bench_run_interp(bench_data_t *d)
+{
+    // Resample signal onto grid offset by half a sample
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->out2[i] = (float32_t)i;
+        d->out3[i] = (float32_t)i + 0.5f;
+    }
+    pk_inter1d_f32(d->out2, d->x, d->len, d->out3, d->out1, d->len - 1);
+}
+
+static uint32_t
+bench_scratch_spline(bench_data_t *d)
+{
+    spline_f32_t ctx = {.xLen = d->len};
+    return pk_spline_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_spline(bench_data_t *d)
+{
+    // Same grid as bench_run_interp, solved and evaluated once
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->out2[i] = (float32_t)i;
+        d->out3[i] = (float32_t)i + 0.5f;
+    }
+    spline_f32_t ctx = {.x = d->out2, .y = d->x, .xLen = d->len, .state = d->scratch};
+    pk_init_spline_f32(&ctx);
+    pk_spline_eval_f32(&ctx, d->out3, d->out1, d->len - 1);
+}
+
+static void
+bench_run_binary_search(bench_data_t *d)
+{
+    size_t acc = 0;
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->out2[i] = (float32_t)i;
+    }
+    for (size_t i = 0; i < d->len; i++)
+    {
+        acc += pk_binary_search_f32(d->out2, d->len, d->x[i] * d->len);
+    }
+    d->peaks[0] = (uint32_t)acc;
+}
+
+static uint32_t
+bench_scratch_eytzinger(bench_data_t *d)
+{
+    return 2 * pk_eytzinger_state_size_f32(d->len) * sizeof(float32_t);
+}
+
+static void
+bench_run_eytzinger(bench_data_t *d)
+{
+    // Same sorted table and queries as bench_run_binary_search
+    eytzinger_f32_t ctx = {
+        .len = d->len, .tree = d->scratch, .rank = (uint32_t *)&d->scratch[pk_eytzinger_state_size_f32(d->len)]};
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->out2[i] = (float32_t)i;
+        d->out3[i] = d->x[i] * d->len;
+    }
+    pk_init_eytzinger_f32(&ctx, d->out2);
+    pk_eytzinger_lower_bound_batch_f32(&ctx, d->out3, d->peaks, d->len);
+}
+
+static uint32_t
+bench_scratch_radix_sort_u32(bench_data_t *d)
+{
+    return pk_radix_sort_workspace_size(d->len, 1) * sizeof(uint32_t);
+}
+
+static void
+bench_run_radix_sort_u32(bench_data_t *d)
+{
+    // Argsort of signal quantized to unsigned counts
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->peaks[i] = (uint32_t)(d->xq15[i] + 32768);
+        d->rri[i] = i;
+    }
+    pk_radix_sort_u32(d->peaks, d->rri, d->len, (uint32_t *)d->scratch);
+}
+
+static uint32_t
+bench_scratch_radix_sort_f32(bench_data_t *d)
+{
+    return pk_radix_sort_workspace_size_f32(d->len, 0) * sizeof(uint32_t);
+}
+
+static void
+bench_run_radix_sort_f32(bench_data_t *d)
+{
+    memcpy(d->out1, d->x, d->len * sizeof(float32_t));
+    pk_radix_sort_f32(d->out1, NULL, d->len, (uint32_t *)d->scratch);
+}
+
+static uint32_t
+bench_scratch_ecg_peaks(bench_data_t *d)
+{
+    ecg_peak_f32_t ctx = {.avgWin = 1.0f, .sampleRate = d->fs};
+    return pk_ecg_peak_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_ecg_peaks(bench_data_t *d)
+{
+    ecg_peak_f32_t ctx = {
+        .qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsMinLenWeight = 0.4f, .qrsDelayWin = 0.3f, .sampleRate = d->fs, .state = d->scratch};
+    d->numPeaks = pk_ecg_find_peaks_f32(&ctx, d->x, d->len, d->peaks, d->mask16);
+    pk_ecg_compute_rr_intervals(d->peaks, d->numPeaks, d->rri);
+    pk_ecg_filter_rr_intervals(d->rri, d->numPeaks, d->mask8, d->fs, 0.3f, 2.0f, 0.3f);
+}
+
+static uint32_t
+bench_scratch_ecg_peaks_q15(bench_data_t *d)
+{
+    ecg_peak_q15_t ctx = {.avgWin = 1.0f, .sampleRate = d->fs};
+    return pk_ecg_peak_state_size_q15(&ctx) * sizeof(q31_t);
+}
+
+static void
+bench_run_ecg_peaks_q15(bench_data_t *d)
+{
+    ecg_peak_q15_t ctx = {
+        .qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsMinLenWeight = 0.4f, .qrsDelayWin = 0.3f, .sampleRate = d->fs, .state = (q31_t *)d->scratch};
+    pk_ecg_find_peaks_q15(&ctx, d->xq15, d->len, d->peaks, d->mask16);
+}
+
+static void
+bench_init_edr(bench_data_t *d, ecg_edr_f32_t *ctx)
+{
+    *ctx = (ecg_edr_f32_t){
+        .windowLen = 32.0f, .interpRate = 4, .lowFreq = 0.1f, .highFreq = 0.5f, .ampWeight = 0.5f, .maxPeaks = 64, .sampleRate = d->fs, .state = d->scratch};
+}
+
+static uint32_t
+bench_scratch_edr(bench_data_t *d)
+{
+    ecg_edr_f32_t ctx;
+    bench_init_edr(d, &ctx);
+    return pk_ecg_edr_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_edr(bench_data_t *d)
+{
+    ecg_edr_f32_t ctx;
+    float32_t respRate;
+    bench_init_edr(d, &ctx);
+    pk_ecg_init_edr_f32(&ctx);
+    pk_ecg_derive_respiratory_rate(&ctx, d->x, d->peaks, d->rri, d->mask8, d->numPeaks, &respRate);
+}
+
+static void
+bench_batch_ctx(bench_data_t *d, batch_ecg_hrv_f32_t *ctx)
+{
+    ecg_peak_f32_t peak = {.qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsMinLenWeight = 0.4f, .qrsDelayWin = 0.3f, .sampleRate = d->fs};
+    ctx->peak = peak;
+    ctx->minRR = 0.3f;
+    ctx->maxRR = 2.0f;
+    ctx->minDelta = 0.3f;
+    ctx->maxLen = d->len / BENCH_BATCH_RECORDS;
+    ctx->numThreads = BENCH_BATCH_THREADS;
+    ctx->state = d->scratch;
+}
+
+static uint32_t
+bench_scratch_batch_ecg_hrv(bench_data_t *d)
+{
+    batch_ecg_hrv_f32_t ctx;
+    bench_batch_ctx(d, &ctx);
+    return pk_batch_ecg_hrv_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_batch_ecg_hrv(bench_data_t *d)
+{
+    // Primary signal split into BENCH_BATCH_RECORDS records
+    batch_ecg_hrv_f32_t ctx;
+    batch_ecg_record_f32_t records[BENCH_BATCH_RECORDS];
+    batch_ecg_hrv_result_f32_t results = {.numPeaks = d->peaks, .numValid = d->rri, .meanNN = d->out1, .sdNN = d->out2, .rmsSD = d->out3};
+    bench_batch_ctx(d, &ctx);
+    for (size_t r = 0; r < BENCH_BATCH_RECORDS; r++)
+    {
+        records[r].ecg = &d->x[r * ctx.maxLen];
+        records[r].ecgLen = ctx.maxLen;
+    }
+    pk_batch_ecg_hrv_f32(&ctx, records, BENCH_BATCH_RECORDS, &results);
+}
+
+static uint32_t
+bench_scratch_ecg_stream(bench_data_t *d)
+{
+    ecg_peak_stream_f32_t ctx = {.qrsWin = 0.1f, .avgWin = 1.0f, .sampleRate = d->fs};
+    return pk_ecg_peak_stream_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_ecg_stream(bench_data_t *d)
+{
+    ecg_peak_stream_f32_t ctx = {
+        .qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsDelayWin = 0.3f, .sampleRate = d->fs, .state = d->scratch};
+    pk_ecg_init_peak_stream_f32(&ctx);
+    for (size_t i = 0; i < d->len; i += 32)
+    {
+        pk_ecg_find_peaks_stream_f32(&ctx, &d->x[i], d->len - i < 32 ? d->len - i : 32, d->peaks);
+    }
+}
+
+static uint32_t
+bench_scratch_ppg_peaks(bench_data_t *d)
+{
+    ppg_peak_f32_t ctx = {.sampleRate = d->fs};
+    return pk_ppg_peak_state_size_f32(&ctx, d->len) * sizeof(float32_t);
+}
+
+static void
+bench_run_ppg_peaks(bench_data_t *d)
+{
+    ppg_peak_f32_t ctx = {.peakWin = 0.111f, .beatWin = 0.667f, .beatOffset = 0.02f, .peakDelayWin = 0.3f, .sampleRate = d->fs, .state = d->scratch};
+    pk_ppg_find_peaks_f32(&ctx, d->x, d->len, d->peaks);
+}
+
+static uint32_t
+bench_scratch_ppg_stream(bench_data_t *d)
+{
+    ppg_peak_stream_f32_t ctx = {.peakWin = 0.111f, .beatWin = 0.667f, .sampleRate = d->fs};
+    return pk_ppg_peak_stream_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_ppg_stream(bench_data_t *d)
+{
+    ppg_peak_stream_f32_t ctx = {
+        .peakWin = 0.111f, .beatWin = 0.667f, .beatOffset = 0.02f, .peakDelayWin = 0.3f, .meanWin = 8.0f, .sampleRate = d->fs, .state = d->scratch};
+    pk_ppg_init_peak_stream_f32(&ctx);
+    for (size_t i = 0; i < d->len; i += 32)
+    {
+        pk_ppg_find_peaks_stream_f32(&ctx, &d->x[i], d->len - i < 32 ? d->len - i : 32, d->peaks);
+    }
+}
+
+static void
+bench_run_ppg_spo2(bench_data_t *d)
+{
+    float32_t coefs[3] = {-16.666666f, 8.333333f, 100.0f};
+    d->out1[0] = pk_ppg_compute_spo2_in_time_f32(d->x, d->y, 1.0f, 1.0f, d->len, coefs, d->fs);
+}
+
+static uint32_t
+bench_scratch_rsp_peaks(bench_data_t *d)
+{
+    rsp_peak_f32_t ctx = {.sampleRate = d->fs};
+    return pk_rsp_peak_state_size_f32(&ctx, d->len) * sizeof(float32_t);
+}
+
+static void
+bench_run_rsp_peaks(bench_data_t *d)
+{
+    rsp_peak_f32_t ctx = {.peakWin = 0.5f, .breathWin = 2.0f, .breathOffset = 0.05f, .peakDelayWin = 0.3f, .sampleRate = d->fs, .state = d->scratch};
+    pk_rsp_find_peaks_f32(&ctx, d->x, d->len, d->peaks);
+}
+
+static uint32_t
+bench_scratch_rsp_stream(bench_data_t *d)
+{
+    rsp_peak_stream_f32_t ctx = {.peakWin = 0.5f, .breathWin = 2.0f, .sampleRate = d->fs};
+    return pk_rsp_peak_stream_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_rsp_stream(bench_data_t *d)
+{
+    rsp_peak_stream_f32_t ctx = {
+        .peakWin = 0.5f, .breathWin = 2.0f, .breathOffset = 0.05f, .peakDelayWin = 0.3f, .meanWin = 30.0f, .sampleRate = d->fs, .state = d->scratch};
+    pk_rsp_init_peak_stream_f32(&ctx);
+    for (size_t i = 0; i < d->len; i += 32)
+    {
+        pk_rsp_find_peaks_stream_f32(&ctx, &d->x[i], d->len - i < 32 ? d->len - i : 32, d->peaks, d->rri);
+    }
+}
+
+static void
+bench_run_hrv_time(bench_data_t *d)
+{
+    hrv_td_metrics_t metrics;
+    pk_hrv_compute_time_metrics_from_rr_intervals(d->rri, d->len, d->mask8, &metrics, d->fs, d->scratch);
+}
+
+static uint32_t
+bench_scratch_hrv_time(bench_data_t *d)
+{
+    return pk_hrv_time_metrics_workspace_size(d->len) * sizeof(float32_t);
+}
+
+static uint32_t
+bench_scratch_hrv_freq(bench_data_t *d)
+{
+    return pk_hrv_freq_metrics_workspace_size(1.0f / 600) * sizeof(float32_t);
+}
+
+static void
+bench_run_hrv_freq(bench_data_t *d)
+{
+    hrv_fd_metrics_t metrics;
+    pk_hrv_compute_freq_metrics_from_rr_intervals(d->rri, d->len, d->mask8, &metrics, d->fs, 1.0f / 600, d->scratch);
+}
+
+static uint32_t
+bench_scratch_hrv_stream(bench_data_t *d)
+{
+    return 3 * d->len * sizeof(uint32_t);
+}
+
+static void
+bench_run_hrv_stream(bench_data_t *d)
+{
+    hrv_td_metrics_t metrics;
+    hrv_td_stream_t ctx = {.windowLen = 300, .sampleRate = d->fs, .capacity = d->len, .state = (uint32_t *)d->scratch};
+    pk_hrv_init_stream(&ctx);
+    for (size_t i = 0; i < d->len; i++)
+    {
+        pk_hrv_stream_push_rr_interval(&ctx, d->rri[i], d->mask8[i]);
+        pk_hrv_stream_get_time_metrics(&ctx, &metrics);
+    }
+}
+
+static void
+bench_run_imu_enmo(bench_data_t *d)
+{
+    pk_imu_compute_enmo_f32(d->x, d->y, d->z, d->out1, d->len);
+}
+
+static uint32_t
+bench_scratch_resample_categorical(bench_data_t *d)
+{
+    resample_u32_t ctx = {.upSample = 100, .downSample = d->fs, .tapsPerPhase = 16};
+    return pk_resample_categorical_state_size_u32(&ctx) * sizeof(uint32_t);
+}
+
+static void
+bench_run_resample_categorical(bench_data_t *d)
+{
+    // Labels aligned with pk_resample_signal_f32 to 100 Hz model rate
+    resample_u32_t ctx = {.upSample = 100, .downSample = d->fs, .tapsPerPhase = 16, .state = (uint32_t *)d->scratch};
+    pk_init_resample_categorical_u32(&ctx);
+    pk_resample_categorical_u32(&ctx, d->labels, d->rri, d->len);
+}
+
+static void
+bench_run_imu_tilt(bench_data_t *d)
+{
+    pk_imu_compute_tilt_angles_f32(d->x, d->y, d->z, d->out1, d->out2, d->out3, d->len);
+}
+
+static void
+bench_run_imu_pitch_roll(bench_data_t *d)
+{
+    pk_imu_compute_pitch_roll_f32(d->x, d->y, d->z, d->out1, d->out2, d->len);
+}
+
+static uint32_t
+bench_scratch_imu_features(bench_data_t *d)
+{
+    return 3 * d->len * sizeof(float32_t);
+}
+
+static void
+bench_run_imu_features(bench_data_t *d, uint32_t mathMode)
+{
+    imu_features_f32_t features = {
+        .enmo = d->out1, .xAngle = d->out2, .yAngle = d->out3, .zAngle = d->scratch, .pitch = &d->scratch[d->len], .roll = &d->scratch[2 * d->len]};
+    pk_imu_compute_features_f32(d->x, d->y, d->z, &features, d->len, mathMode);
+}
+
+static void
+bench_run_imu_features_exact(bench_data_t *d)
+{
+    bench_run_imu_features(d, PK_IMU_MATH_EXACT);
+}
+
+static void
+bench_run_imu_features_fast(bench_data_t *d)
+{
+    bench_run_imu_features(d, PK_IMU_MATH_FAST);
+}
+
+static void
+bench_init_imu_activity(bench_data_t *d, imu_activity_f32_t *ctx)
+{
+    *ctx = (imu_activity_f32_t){.epochLen = 5.0f, .stillWin = 1.0f, .stillThresh = 0.013f, .thresholds = {0.1f, 0.4f}, .numThresholds = 2, .sampleRate = d->fs, .state = d->scratch};
+}
+
+static uint32_t
+bench_scratch_imu_activity(bench_data_t *d)
+{
+    imu_activity_f32_t ctx;
+    bench_init_imu_activity(d, &ctx);
+    return pk_imu_activity_state_size_f32(&ctx) * sizeof(float32_t);
+}
+
+static void
+bench_run_imu_activity(bench_data_t *d)
+{
+    // Push one second blocks as a device would
+    imu_activity_f32_t ctx;
+    imu_activity_epoch_t epochs[2];
+    bench_init_imu_activity(d, &ctx);
+    pk_imu_init_activity_f32(&ctx);
+    for (size_t i = 0; i + d->fs <= d->len; i += d->fs)
+    {
+        pk_imu_activity_push_f32(&ctx, &d->x[i], &d->y[i], &d->z[i], d->fs, epochs);
+    }
+}
+
+static const bench_case_t benchCases[] = {
+    {"pk_mean_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_mean},
+    {"pk_std_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_std},
+    {"pk_rms_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_rms},
+    {"pk_gradient_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_gradient},
+    {"pk_smooth_signal_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_smooth},
+    {"pk_apply_moving_average_f32", BENCH_SIG_ECG, bench_scratch_moving_average, bench_run_moving_average},
+    {"pk_standardize_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_standardize},
+    {"pk_apply_biquad_filter_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_biquad},
+    {"pk_apply_biquad_multi_f32", BENCH_SIG_ECG, bench_scratch_biquad_multi, bench_run_biquad_multi},
+    {"pk_apply_biquad_filtfilt_f32", BENCH_SIG_ECG, bench_scratch_filtfilt, bench_run_filtfilt},
+    {"pk_apply_biquad_filtfilt_stream_f32", BENCH_SIG_ECG, bench_scratch_filtfilt_stream, bench_run_filtfilt_stream},
+    {"pk_linear_downsample_f32", BENCH_SIG_PPG, bench_scratch_none, bench_run_linear_downsample},
+    {"pk_interp_resample_f32", BENCH_SIG_PPG, bench_scratch_none, bench_run_interp_resample},
+    {"pk_resample_signal_f32", BENCH_SIG_ECG, bench_scratch_resample, bench_run_resample},
+    {"pk_resample_categorical_u32", BENCH_SIG_ECG, bench_scratch_resample_categorical, bench_run_resample_categorical},
+    {"pk_blackman_window_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_blackman},
+    {"rescale_signal_f32", BENCH_SIG_ECG, bench_scratch_none, bench_run_rescale},
+    {"pk_quotient_filter_mask_u32", BENCH_SIG_RR, bench_scratch_none, bench_run_quotient},
+    {"pk_inter1d_f32", BENCH_SIG_RSP, bench_scratch_none, bench_run_interp},
+    {"pk_spline_eval_f32", BENCH_SIG_RSP, bench_scratch_spline, bench_run_spline},
+    {"pk_binary_search_f32", BENCH_SIG_RSP, bench_scratch_none, bench_run_binary_search},
+    {"pk_eytzinger_lower_bound_batch_f32", BENCH_SIG_RSP, bench_scratch_eytzinger, bench_run_eytzinger},
+    {"pk_radix_sort_u32", BENCH_SIG_ECG, bench_scratch_radix_sort_u32, bench_run_radix_sort_u32},
+    {"pk_radix_sort_f32", BENCH_SIG_ECG, bench_scratch_radix_sort_f32, bench_run_radix_sort_f32},
+    {"pk_ecg_find_peaks_f32", BENCH_SIG_ECG, bench_scratch_ecg_peaks, bench_run_ecg_peaks},
+    {"pk_ecg_find_peaks_q15", BENCH_SIG_ECG, bench_scratch_ecg_peaks_q15, bench_run_ecg_peaks_q15},
+    {"pk_batch_ecg_hrv_f32", BENCH_SIG_ECG, bench_scratch_batch_ecg_hrv, bench_run_batch_ecg_hrv},
+    {"pk_ecg_derive_respiratory_rate", BENCH_SIG_ECG, bench_scratch_edr, bench_run_edr},
+    {"pk_ecg_find_peaks_stream_f32", BENCH_SIG_ECG, bench_scratch_ecg_stream, bench_run_ecg_stream},
+    {"pk_ppg_find_peaks_f32", BENCH_SIG_PPG, bench_scratch_ppg_peaks, bench_run_ppg_peaks},
+    {"pk_ppg_find_peaks_stream_f32", BENCH_SIG_PPG, bench_scratch_ppg_stream, bench_run_ppg_stream},
+    {"pk_ppg_compute_spo2_in_time_f32", BENCH_SIG_PPG, bench_scratch_none, bench_run_ppg_spo2},
+    {"pk_rsp_find_peaks_f32", BENCH_SIG_RSP, bench_scratch_rsp_peaks, bench_run_rsp_peaks},
+    {"pk_rsp_find_peaks_stream_f32", BENCH_SIG_RSP, bench_scratch_rsp_stream, bench_run_rsp_stream},
+    {"pk_hrv_compute_time_metrics_from_rr_intervals", BENCH_SIG_RR, bench_scratch_hrv_time, bench_run_hrv_time},
+    {"pk_hrv_compute_freq_metrics_from_rr_intervals", BENCH_SIG_RR, bench_scratch_hrv_freq, bench_run_hrv_freq},
+    {"pk_hrv_stream_push_rr_interval", BENCH_SIG_RR, bench_scratch_hrv_stream, bench_run_hrv_stream},
+    {"pk_imu_compute_enmo_f32", BENCH_SIG_IMU, bench_scratch_none, bench_run_imu_enmo},
+    {"pk_imu_compute_tilt_angles_f32", BENCH_SIG_IMU, bench_scratch_none, bench_run_imu_tilt},
+    {"pk_imu_compute_pitch_roll_f32", BENCH_SIG_IMU, bench_scratch_none, bench_run_imu_pitch_roll},
+    {"pk_imu_compute_features_f32", BENCH_SIG_IMU, bench_scratch_imu_features, bench_run_imu_features_exact},
+    {"pk_imu_compute_features_f32_fast", BENCH_SIG_IMU, bench_scratch_imu_features, bench_run_imu_features_fast},
+    {"pk_imu_activity_push_f32", BENCH_SIG_IMU, bench_scratch_imu_activity, bench_run_imu_activity},
+};
+
+// Sample rates (Hz) per signal type. RR "rate" is the tick rate of intervals.
+static const uint32_t benchRates[][2] = {
+    {250, 500}, // ECG
+    {64, 250}, // PPG
+    {25, 100}, // RSP
+    {50, 100}, // IMU
+    {250, 1000}, // RR
+};
+
+// Lengths in seconds (beats for RR)
+static const uint32_t benchDurations[] = {10, 60, 300};
+
+/******************************************************************************
+ * Checks
+ ******************************************************************************/
+
+static void
+bench_prepare(bench_data_t *d, bench_signal_t signal, uint32_t fs, uint32_t len);
+
+// ADC counts per signal unit for q15 equivalence checks
+static const float32_t benchCheckGains[] = {100.0f, BENCH_Q15_SCALE, 8000.0f};
+
+static uint32_t
+bench_check_ecg_peaks_q15(bench_data_t *d, float32_t gain, uint32_t *peaksF32, uint16_t *maskF32)
+{
+    ecg_peak_f32_t ctxF32 = {
+        .qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsMinLenWeight = 0.4f, .qrsDelayWin = 0.3f, .sampleRate = d->fs, .state = d->scratch};
+    ecg_peak_q15_t ctxQ15 = {
+        .qrsWin = 0.1f, .avgWin = 1.0f, .qrsPromWeight = 1.5f, .qrsMinLenWeight = 0.4f, .qrsDelayWin = 0.3f, .sampleRate = d->fs};
+    ctxQ15.state = (q31_t *)&d->scratch[pk_ecg_peak_state_size_f32(&ctxF32)];
+    // Both detectors see the same quantized ADC counts
+    for (size_t i = 0; i < d->len; i++)
+    {
+        d->xq15[i] = (q15_t)__SSAT((q31_t)roundf(d->x[i] * gain), 16);
+        d->out1[i] = d->xq15[i];
+    }
+    uint32_t numF32 = pk_ecg_find_peaks_f32(&ctxF32, d->out1, d->len, peaksF32, maskF32);
+    uint32_t numQ15 = pk_ecg_find_peaks_q15(&ctxQ15, d->xq15, d->len, d->peaks, d->mask16);
+    uint32_t mismatches = numF32 > numQ15 ? numF32 - numQ15 : numQ15 - numF32;
+    for (size_t i = 0; i < numF32 && i < numQ15; i++)
+    {
+        mismatches += peaksF32[i] != d->peaks[i] ? 1 : 0;
+    }
+    for (size_t i = 0; i < d->len; i++)
+    {
+        mismatches += maskF32[i] != d->mask16[i] ? 1 : 0;
+    }
+    printf("{\"check\": \"pk_ecg_find_peaks_q15\", \"backend\": \"%s\", \"fs\": %u, \"len\": %u, \"gain\": %.0f, \"peaks\": %u, \"mismatches\": %u}\n",
+           pk_dsp_get_backend()->name, d->fs, d->len, gain, numF32, mismatches);
+    fflush(stdout);
+    return mismatches;
+}
+
+static uint32_t
+bench_run_checks(bench_data_t *d)
+{
+    uint32_t failures = 0;
+    uint32_t *peaksF32 = calloc(BENCH_MAX_LEN, sizeof(uint32_t));
+    uint16_t *maskF32 = calloc(BENCH_MAX_LEN, sizeof(uint16_t));
+    if (!peaksF32 || !maskF32)
+    {
+        fprintf(stderr, "pk_bench: out of memory\n");
+        free(peaksF32);
+        free(maskF32);
+        return 1;
+    }
+    for (size_t r = 0; r < 2; r++)
+    {
+        uint32_t fs = benchRates[BENCH_SIG_ECG][r];
+        for (size_t l = 0; l < sizeof(benchDurations) / sizeof(benchDurations[0]); l++)
+        {
+            uint32_t len = benchDurations[l] * fs;
+            if (len > BENCH_MAX_LEN)
+            {
+                continue;
+            }
+            for (size_t g = 0; g < sizeof(benchCheckGains) / sizeof(benchCheckGains[0]); g++)
+            {
+                bench_prepare(d, BENCH_SIG_ECG, fs, len);
+                failures += bench_check_ecg_peaks_q15(d, benchCheckGains[g], peaksF32, maskF32) != 0 ? 1 : 0;
+            }
+        }
+    }
+    free(peaksF32);
+    free(maskF32);
+    return failures;
+}
+
+/******************************************************************************
+ * Driver
+ ******************************************************************************/
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+bench_prepare(bench_data_t *d, bench_signal_t signal, uint32_t fs, uint32_t len)
+{
+    benchSeed = 1;
+    d->fs = fs;
+    d->len = len;
+    switch (signal)
+    {
+    case BENCH_SIG_ECG:
+        bench_synth_ecg(d->x, len, fs);
+        bench_lowpass_biquad(&d->biquadCoefs[0], 40.0f, fs);
+        // Reference beats for kernels consuming R peaks
+        bench_run_ecg_peaks(d);
+        break;
+    case BENCH_SIG_PPG:
+        bench_synth_ppg(d->x, len, fs);
+        bench_synth_ppg(d->y, len, fs);
+        bench_lowpass_biquad(&d->biquadCoefs[0], 4.0f, fs);
+        break;
+    case BENCH_SIG_RSP:
+        bench_synth_rsp(d->x, len, fs);
+        bench_lowpass_biquad(&d->biquadCoefs[0], 1.0f, fs);
+        break;
+    case BENCH_SIG_IMU:
+        bench_synth_imu(d->x, d->y, d->z, len, fs);
+        bench_lowpass_biquad(&d->biquadCoefs[0], 10.0f, fs);
+        break;
+    case BENCH_SIG_RR:
+        bench_synth_rr(d->rri, d->mask8, len, fs);
+        bench_lowpass_biquad(&d->biquadCoefs[0], 1.0f, 4.0f);
+        break;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        d->xq15[i] = (q15_t)__SSAT((q31_t)roundf(d->x[i] * BENCH_Q15_SCALE), 16);
+        // Three classes by amplitude (e.g. baseline / wave / QRS)
+        d->labels[i] = d->x[i] > 0.5f ? 2 : (d->x[i] > 0.2f ? 1 : 0);
+    }
+    // Second section repeats the first for a 4th order response
+    memcpy(&d->biquadCoefs[5], &d->biquadCoefs[0], 5 * sizeof(float32_t));
+    d->biquad.numStages = BENCH_BIQUAD_SECS;
+    d->biquad.pCoeffs = d->biquadCoefs;
+    d->biquad.pState = d->biquadState;
+    pk_init_biquad_filter_f32(&d->biquad);
+}
+
+static void
+bench_run_case(const bench_case_t *bc, bench_data_t *d)
+{
+    uint64_t iters = 1, elapsed = 0, best = UINT64_MAX;
+    uint64_t start;
+
+    // Calibrate iteration count to run at least BENCH_MIN_NS
+    bc->run(d);
+    while (1)
+    {
+        start = bench_now_ns();
+        for (uint64_t i = 0; i < iters; i++)
+        {
+            bc->run(d);
+        }
+        elapsed = bench_now_ns() - start;
+        if (elapsed >= BENCH_MIN_NS || iters >= (1ULL << 30))
+        {
+            break;
+        }
+        iters *= 2;
+    }
+    // Report best of several repeats
+    for (size_t r = 0; r < BENCH_REPEATS; r++)
+    {
+        start = bench_now_ns();
+        for (uint64_t i = 0; i < iters; i++)
+        {
+            bc->run(d);
+        }
+        elapsed = bench_now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    double nsPerSample = (double)best / ((double)iters * d->len);
+    printf("{\"func\": \"%s\", \"backend\": \"%s\", \"signal\": \"%s\", \"fs\": %u, \"len\": %u, \"ns_per_sample\": %.3f, \"samples_per_s\": %.0f, \"scratch_bytes\": %u}\n",
+           bc->name, pk_dsp_get_backend()->name, benchSignalNames[bc->signal], d->fs, d->len, nsPerSample, 1e9 / nsPerSample, bc->scratch(d));
+    fflush(stdout);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const char *backendNames[] = {"auto", "cmsis", "ref", "avx2", "neon"};
+    const char *filter = argc > 1 && argv[1][0] != '\0' ? argv[1] : NULL;
+    uint32_t backend = PK_DSP_BACKEND_AUTO;
+    if (argc > 2)
+    {
+        for (backend = 0; backend < 5 && strcmp(argv[2], backendNames[backend]) != 0; backend++)
+        {
+        }
+    }
+    if (pk_dsp_init(backend) != 0)
+    {
+        fprintf(stderr, "pk_bench: backend unavailable\n");
+        return 1;
+    }
+    bench_data_t d;
+    d.x = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.xq15 = calloc(BENCH_MAX_LEN, sizeof(q15_t));
+    d.y = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.z = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.out1 = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.out2 = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.out3 = calloc(BENCH_MAX_LEN, sizeof(float32_t));
+    d.scratch = calloc(4 * BENCH_MAX_LEN, sizeof(float32_t));
+    d.peaks = calloc(BENCH_MAX_LEN, sizeof(uint32_t));
+    d.rri = calloc(BENCH_MAX_LEN, sizeof(uint32_t));
+    d.labels = calloc(BENCH_MAX_LEN, sizeof(uint32_t));
+    d.mask8 = calloc(BENCH_MAX_LEN, sizeof(uint8_t));
+    d.mask16 = calloc(BENCH_MAX_LEN, sizeof(uint16_t));
+    if (!d.x || !d.xq15 || !d.y || !d.z || !d.out1 || !d.out2 || !d.out3 || !d.scratch || !d.peaks || !d.rri || !d.labels || !d.mask8 || !d.mask16)
+    {
+        fprintf(stderr, "pk_bench: out of memory\n");
+        return 1;
+    }
+
+    if (filter != NULL && strcmp(filter, "check") == 0)
+    {
+        return bench_run_checks(&d) != 0 ? 1 : 0;
+    }
+
+    for (size_t c = 0; c < sizeof(benchCases) / sizeof(benchCases[0]); c++)
+    {
+        const bench_case_t *bc = &benchCases[c];
+        if (filter != NULL && strstr(bc->name, filter) == NULL)
+        {
+            continue;
+        }
+        for (size_t r = 0; r < 2; r++)
+        {
+            uint32_t fs = benchRates[bc->signal][r];
+            for (size_t l = 0; l < sizeof(benchDurations) / sizeof(benchDurations[0]); l++)
+            {
+                // RR series are measured in beats, all others in seconds
+                uint32_t len = bc->signal == BENCH_SIG_RR ? benchDurations[l] : benchDurations[l] * fs;
+                if (len > BENCH_MAX_LEN)
+                {
+                    continue;
+                }
+                bench_prepare(&d, bc->signal, fs, len);
+                bench_run_case(bc, &d);
+            }
+        }
+    }
+    return 0;
+}
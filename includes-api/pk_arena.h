@@ -0,0 +1,98 @@
+/**
+ * @file pk_arena.h
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Scratch arena
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Stack (bump) allocator over a caller provided buffer. Stages that run one
+ * after another (e.g. ECG, PPG, RSP peak detection then HRV) can draw their
+ * state/workspace from one shared region sized by the matching
+ * *_state_size / *_workspace_size queries, releasing back to a mark when done:
+ *
+ *     uint32_t mark = pk_arena_mark(&arena);
+ *     ctx.state = pk_arena_alloc_f32(&arena, pk_ecg_peak_state_size_f32(&ctx));
+ *     numPeaks = pk_ecg_find_peaks_f32(&ctx, ecg, ecgLen, peaks, NULL);
+ *     pk_arena_release(&arena, mark);
+ *
+ * The high water mark reports the region size actually needed.
+ */
+#ifndef __PK_ARENA_H
+#define __PK_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "arm_math.h"
+
+#ifndef PK_ARENA_ALIGN
+#define PK_ARENA_ALIGN (8) // Allocation alignment in bytes (power of 2)
+#endif
+
+typedef struct
+{
+    uint8_t *buffer; // Backing memory
+    uint32_t size; // Size of backing memory in bytes
+    uint32_t used; // Bytes currently allocated
+    uint32_t peak; // High water mark in bytes
+} pk_arena_t;
+
+/**
+ * @brief Initialize arena over buffer
+ *
+ * @param arena Arena
+ * @param buffer Backing memory
+ * @param size Size of backing memory in bytes
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_arena_init(pk_arena_t *arena, void *buffer, uint32_t size);
+
+/**
+ * @brief Allocate bytes from arena (PK_ARENA_ALIGN aligned)
+ *
+ * @param arena Arena
+ * @param size Bytes to allocate
+ * @return void* Allocation or NULL if arena is exhausted
+ */
+void *
+pk_arena_alloc(pk_arena_t *arena, uint32_t size);
+
+/**
+ * @brief Allocate float32_t elements from arena
+ *
+ * @param arena Arena
+ * @param len Number of elements
+ * @return float32_t* Allocation or NULL if arena is exhausted
+ */
+float32_t *
+pk_arena_alloc_f32(pk_arena_t *arena, uint32_t len);
+
+/**
+ * @brief Get current arena position to release back to
+ *
+ * @param arena Arena
+ * @return uint32_t Mark
+ */
+uint32_t
+pk_arena_mark(pk_arena_t *arena);
+
+/**
+ * @brief Release all allocations made after mark
+ *
+ * @param arena Arena
+ * @param mark Mark from pk_arena_mark
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_arena_release(pk_arena_t *arena, uint32_t mark);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PK_ARENA_H
@@ -0,0 +1,107 @@
+/**
+ * @file pk_batch.h
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Batch processing
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Runs a full pipeline over many records at once (e.g. offline reprocessing
+ * of uploaded recordings). Records are claimed in small chunks from a shared
+ * atomic cursor by a pool of worker threads, each with its own detector
+ * state. Every record is processed independently and written to its own
+ * result slot, so results do not depend on the number of threads.
+ *
+ * Threads are only used on hosted builds (PK_BATCH_THREADS=1, pthreads).
+ * Otherwise, or when numThreads <= 1, records run in the calling thread.
+ * Select the DSP backend with pk_dsp_init before calling.
+ */
+#ifndef __PK_BATCH_H
+#define __PK_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arm_math.h"
+#include "pk_config.h"
+#include "pk_ecg.h"
+#include "pk_hrv.h"
+
+#define PK_BATCH_MAX_THREADS (64) // Upper bound on worker threads
+#define PK_BATCH_CHUNK (4) // Records claimed per cursor fetch
+
+typedef struct
+{
+    float32_t *ecg; // ECG signal
+    uint32_t ecgLen; // Length of ECG signal (<= maxLen)
+} batch_ecg_record_f32_t;
+
+typedef struct
+{
+    // Per record arrays of numRecords (NULL to skip)
+    uint32_t *numPeaks; // R peaks found
+    uint32_t *numValid; // RR intervals kept by filter
+    float32_t *meanNN;
+    float32_t *sdNN;
+    float32_t *rmsSD;
+    float32_t *sdSD;
+    float32_t *cvNN;
+    float32_t *cvSD;
+    float32_t *medianNN;
+    float32_t *madNN;
+    float32_t *mcvNN;
+    float32_t *iqrNN;
+    float32_t *prc20NN;
+    float32_t *prc80NN;
+    uint32_t *nn50;
+    uint32_t *nn20;
+    float32_t *pnn50;
+    float32_t *pnn20;
+    float32_t *minNN;
+    float32_t *maxNN;
+} batch_ecg_hrv_result_f32_t;
+
+typedef struct
+{
+    ecg_peak_f32_t peak; // R peak detector config (state is set per worker)
+    float32_t minRR; // Minimum RR interval in secs (0.3)
+    float32_t maxRR; // Maximum RR interval in secs (2.0)
+    float32_t minDelta; // Minimum quotient delta (0.3)
+    uint32_t maxLen; // Maximum record length in samples
+    uint32_t numThreads; // Worker threads incl. caller (<= PK_BATCH_MAX_THREADS)
+    float32_t *state; // Internal state requires pk_batch_ecg_hrv_state_size_f32(ctx)
+} batch_ecg_hrv_f32_t;
+
+/**
+ * @brief Get state length (in float32_t) required by batch ECG HRV pipeline.
+ * Each worker needs peak detector state plus peaks, RR intervals, HRV
+ * scratch and mask sized for the most beats a maxLen record can hold.
+ *
+ * @param ctx Batch context (peak, maxLen, numThreads must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_batch_ecg_hrv_state_size_f32(batch_ecg_hrv_f32_t *ctx);
+
+/**
+ * @brief Run ECG R peak detection, RR interval filtering and time domain
+ * HRV over a batch of records:
+ * pk_ecg_find_peaks_f32 -> pk_ecg_compute_rr_intervals ->
+ * pk_ecg_filter_rr_intervals -> pk_hrv_compute_time_metrics_from_rr_intervals
+ *
+ * @param ctx Batch context
+ * @param records Records to process
+ * @param numRecords Number of records
+ * @param results Result arrays (SoA, one entry per record)
+ * @return uint32_t Result code (1 if any record exceeds maxLen; its results are zeroed)
+ */
+uint32_t
+pk_batch_ecg_hrv_f32(batch_ecg_hrv_f32_t *ctx, const batch_ecg_record_f32_t *records, uint32_t numRecords, batch_ecg_hrv_result_f32_t *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PK_BATCH_H
@@ -0,0 +1,25 @@
+/**
+ * @file pk_config.h
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Build configuration
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Build-time switches shared across modules. Override by defining them
+ * before including any PhysioKit header (e.g. -DPK_BATCH_THREADS=0).
+ */
+#ifndef __PK_CONFIG_H
+#define __PK_CONFIG_H
+
+// Hosted build with pthreads: batch worker pool and locked shared caches
+#ifndef PK_BATCH_THREADS
+#if defined(__unix__) || defined(__APPLE__)
+#define PK_BATCH_THREADS (1)
+#else
+#define PK_BATCH_THREADS (0)
+#endif
+#endif
+
+#endif // __PK_CONFIG_H
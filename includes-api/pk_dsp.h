@@ -0,0 +1,211 @@
+/**
+ * @file pk_dsp.h
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: DSP backend
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Thin layer over the vector kernels used by pk_math/pk_filter and the peak
+ * detectors. Backends:
+ *  - CMSIS: CMSIS-DSP arm_* kernels (default on Arm targets, uses MVE/NEON
+ *    when CMSIS-DSP is built with ARM_MATH_MVEF/ARM_MATH_NEON)
+ *  - REF: portable scalar C reference
+ *  - AVX2: x86-64 AVX2/FMA (compiled via target attributes, CPU checked at init)
+ *  - NEON: AArch64 Advanced SIMD
+ *
+ * Define PK_DSP_BACKEND at build time to fix the default backend, or call
+ * pk_dsp_init(PK_DSP_BACKEND_AUTO) at startup to pick the best available one.
+ */
+
+#ifndef __PK_DSP_H
+#define __PK_DSP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "arm_math.h"
+
+#define PK_DSP_BACKEND_AUTO (0)
+#define PK_DSP_BACKEND_CMSIS (1)
+#define PK_DSP_BACKEND_REF (2)
+#define PK_DSP_BACKEND_AVX2 (3)
+#define PK_DSP_BACKEND_NEON (4)
+
+#ifndef PK_DSP_BACKEND
+#if defined(__ARM_ARCH) && !defined(__aarch64__)
+#define PK_DSP_BACKEND PK_DSP_BACKEND_CMSIS
+#else
+#define PK_DSP_BACKEND PK_DSP_BACKEND_AUTO
+#endif
+#endif
+
+typedef struct
+{
+    uint32_t numChannels; // Interleaved channels
+    uint32_t numStages; // Biquad stages per channel
+    float32_t *pCoeffs; // SoA coefficients requires 5*numStages*numChannels: per stage {b0[C], b1[C], b2[C], a1[C], a2[C]}
+    float32_t *pState; // SoA state requires 4*numStages*numChannels: per stage {x1[C], x2[C], y1[C], y2[C]}
+} biquad_multi_f32_t;
+
+typedef struct
+{
+    const char *name;
+    void (*dot_prod)(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult);
+    void (*max)(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+    void (*mean)(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+    void (*var)(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+    void (*rms)(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+    void (*abs)(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+    void (*scale)(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+    void (*offset)(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize);
+    void (*sub)(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+    void (*biquad_df1)(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+    void (*biquad_df1_multi)(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+} pk_dsp_backend_t;
+
+/**
+ * @brief Select DSP backend. PK_DSP_BACKEND_AUTO picks the fastest backend
+ * supported by the build and the running CPU.
+ *
+ * @param backend Backend ID (PK_DSP_BACKEND_*)
+ * @return uint32_t Result code (1 if backend is unavailable)
+ */
+uint32_t
+pk_dsp_init(uint32_t backend);
+
+/**
+ * @brief Get active DSP backend. Resolved from PK_DSP_BACKEND on first use
+ * if pk_dsp_init has not been called; safe to call from multiple threads.
+ *
+ * @return const pk_dsp_backend_t* Active backend
+ */
+const pk_dsp_backend_t *
+pk_dsp_get_backend(void);
+
+/**
+ * @brief Dot product of two signals
+ *
+ * @param pSrcA First signal
+ * @param pSrcB Second signal
+ * @param blockSize Length of signals
+ * @param pResult Result
+ */
+void
+pk_dsp_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult);
+
+/**
+ * @brief Maximum value and index of first occurrence
+ *
+ * @param pSrc Source signal
+ * @param blockSize Length of signal
+ * @param pResult Maximum value
+ * @param pIndex Index of maximum value
+ */
+void
+pk_dsp_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+
+/**
+ * @brief Mean of a signal
+ *
+ * @param pSrc Source signal
+ * @param blockSize Length of signal
+ * @param pResult Mean
+ */
+void
+pk_dsp_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+
+/**
+ * @brief Sample variance (N-1) of a signal
+ *
+ * @param pSrc Source signal
+ * @param blockSize Length of signal
+ * @param pResult Variance
+ */
+void
+pk_dsp_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+
+/**
+ * @brief Root mean square of a signal
+ *
+ * @param pSrc Source signal
+ * @param blockSize Length of signal
+ * @param pResult RMS
+ */
+void
+pk_dsp_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+
+/**
+ * @brief Element-wise absolute value
+ *
+ * @param pSrc Source signal
+ * @param pDst Result signal
+ * @param blockSize Length of signal
+ */
+void
+pk_dsp_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Element-wise scale
+ *
+ * @param pSrc Source signal
+ * @param scale Scale factor
+ * @param pDst Result signal
+ * @param blockSize Length of signal
+ */
+void
+pk_dsp_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Element-wise offset
+ *
+ * @param pSrc Source signal
+ * @param offset Offset
+ * @param pDst Result signal
+ * @param blockSize Length of signal
+ */
+void
+pk_dsp_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Element-wise subtraction A - B
+ *
+ * @param pSrcA First signal
+ * @param pSrcB Second signal
+ * @param pDst Result signal
+ * @param blockSize Length of signals
+ */
+void
+pk_dsp_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Biquad cascade (direct form I, CMSIS coefficient and state layout)
+ *
+ * @param ctx Filter instance
+ * @param pSrc Source signal
+ * @param pDst Result signal
+ * @param blockSize Length of signal
+ */
+void
+pk_dsp_biquad_df1_f32(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Multi-channel biquad cascade (direct form I) on interleaved samples.
+ * Channels are independent so the recursion is vectorized across channels.
+ *
+ * @param ctx Filter instance
+ * @param pSrc Source signal (blockSize*numChannels interleaved)
+ * @param pDst Result signal (may alias pSrc)
+ * @param blockSize Samples per channel
+ */
+void
+pk_dsp_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PK_DSP_H
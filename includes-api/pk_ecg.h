@@ -16,6 +16,9 @@ extern "C" {
 #endif
 
 #include "arm_math.h"
+#include "pk_filter.h"
+
+#define PK_ECG_STREAM_CHUNK (32) // Samples processed per internal chunk in streaming mode
 
 typedef struct
 {
@@ -25,9 +28,72 @@ typedef struct
     float32_t qrsMinLenWeight; // QRS minimum length in secs (0.4)
     float32_t qrsDelayWin; // Minimum delay between successive QRS peaks in secs (0.3)
     uint32_t sampleRate; // Sample rate in Hz
-    float32_t *state; // Interal state requires 4*ecgLen
+    float32_t *state; // Internal state requires pk_ecg_peak_state_size_f32(ctx)
 } ecg_peak_f32_t;
 
+typedef struct
+{
+    float32_t qrsWin; // QRS window length in secs (0.1)
+    float32_t avgWin; // Average window length in secs (1.0)
+    float32_t qrsPromWeight; // QRS prominent weight (1.5)
+    float32_t qrsMinLenWeight; // QRS minimum length in secs (0.4)
+    float32_t qrsDelayWin; // Minimum delay between successive QRS peaks in secs (0.3)
+    uint32_t sampleRate; // Sample rate in Hz
+    q31_t *state; // Internal state requires pk_ecg_peak_state_size_q15(ctx)
+} ecg_peak_q15_t;
+
+typedef struct
+{
+    float32_t qrsWin; // QRS window length in secs (0.1)
+    float32_t avgWin; // Average window length in secs (1.0)
+    float32_t qrsPromWeight; // QRS prominent weight (1.5)
+    float32_t qrsDelayWin; // Minimum delay between successive QRS peaks in secs (0.3)
+    uint32_t sampleRate; // Sample rate in Hz
+    float32_t *state; // Internal state requires pk_ecg_peak_stream_state_size_f32(ctx)
+    // Runtime state (set by pk_ecg_init_peak_stream_f32)
+    moving_avg_f32_t qrsAvg; // QRS gradient smoother
+    moving_avg_f32_t avgAvg; // Average gradient smoother
+    float32_t *ecgBuf; // Delayed ECG samples used to locate peak
+    uint32_t ecgBufLen;
+    uint32_t qrsDelay; // Group delay of QRS smoother in samples
+    uint32_t minQrsDelay; // Minimum delay between peaks in samples
+    float32_t x1; // ECG sample n-1
+    float32_t x2; // ECG sample n-2
+    float32_t prevDiff; // Previous thresholded gradient
+    uint32_t numSamples; // Total samples consumed
+    uint8_t inQrs; // Currently inside QRS region
+    float32_t peakVal; // Max ECG value in current QRS region
+    uint32_t peakIdx; // Absolute index of max in current QRS region
+    uint8_t hasPeak; // Set once a peak has been emitted
+    uint32_t lastPeak; // Absolute index of last emitted peak
+} ecg_peak_stream_f32_t;
+
+typedef struct
+{
+    float32_t windowLen; // Analysis window length in secs (32)
+    uint32_t interpRate; // Interpolation rate in Hz (4)
+    float32_t lowFreq; // Lower respiratory band edge in Hz (0.1)
+    float32_t highFreq; // Upper respiratory band edge in Hz (0.5)
+    float32_t ampWeight; // Weight of R-peak amplitude vs RR modulation (0.5)
+    uint32_t maxPeaks; // Maximum number of peaks per window
+    uint32_t sampleRate; // ECG sample rate in Hz
+    float32_t *state; // Internal state requires pk_ecg_edr_state_size_f32(ctx)
+    // Runtime state (set by pk_ecg_init_edr_f32)
+    uint32_t gridLen; // Interpolation grid length
+    uint32_t fftLen; // FFT length (zero padded)
+    arm_rfft_fast_instance_f32 fftCtx;
+    arm_biquad_casd_df1_inst_f32 filter;
+    float32_t filterCoeffs[10]; // Highpass + lowpass biquad
+    float32_t filterState[8];
+    float32_t *gridTime; // Grid offsets in secs
+    float32_t *beatTime; // Valid beat times in secs
+    float32_t *beatRR; // Valid beat RR intervals in secs
+    float32_t *beatAmp; // Valid beat R-peak amplitudes
+    float32_t *ampSig; // Interpolated amplitude signal
+    float32_t *edrSig; // Interpolated EDR signal (FFT input)
+    float32_t *spec; // FFT output
+} ecg_edr_f32_t;
+
 
 /**
  * @brief Filter out RR intervals that are outside of the min and max range
@@ -43,6 +109,15 @@ typedef struct
 uint32_t
 pk_ecg_square_filter_mask(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, uint32_t sampleRate, float32_t minRR, float32_t maxRR);
 
+/**
+ * @brief Get state length (in float32_t) required by R peak detector
+ *
+ * @param ctx Context (avgWin, sampleRate must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_ecg_peak_state_size_f32(ecg_peak_f32_t *ctx);
+
 /**
  * @brief Find r peaks in ECG signal
  *
@@ -56,6 +131,66 @@ pk_ecg_square_filter_mask(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mas
 uint32_t
 pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint32_t *peaks, uint16_t *mask);
 
+/**
+ * @brief Get state length (in q31_t) required by q15 R peak detector
+ *
+ * @param ctx Context (avgWin, sampleRate must be set)
+ * @return uint32_t Number of q31_t elements
+ */
+uint32_t
+pk_ecg_peak_state_size_q15(ecg_peak_q15_t *ctx);
+
+/**
+ * @brief Find r peaks in raw q15 (int16 ADC) ECG signal.
+ * Same detector as pk_ecg_find_peaks_f32 evaluated in integer arithmetic:
+ * gradient window sums are exact in q31 and the prominence threshold is
+ * compared in 64-bit, so peaks match the float path (up to qrsPromWeight
+ * being quantized to 1/4096).
+ *
+ * @param ctx Context
+ * @param ecg ECG signal
+ * @param ecgLen Length of ECG signal
+ * @param peaks Array of peak indices
+ * @param mask Segmentation mask (QRS region)
+ * @return uint32_t Number of peaks
+ */
+uint32_t
+pk_ecg_find_peaks_q15(ecg_peak_q15_t *ctx, q15_t *ecg, uint32_t ecgLen, uint32_t *peaks, uint16_t *mask);
+
+/**
+ * @brief Get state length (in float32_t) required by streaming R peak detector
+ *
+ * @param ctx Streaming context (qrsWin, avgWin, sampleRate must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_ecg_peak_stream_state_size_f32(ecg_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming R peak detector
+ *
+ * @param ctx Streaming context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_ecg_init_peak_stream_f32(ecg_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Find r peaks in next block of ECG signal.
+ * Applies the same gradient based detector as pk_ecg_find_peaks_f32 but uses
+ * a causal average gradient threshold so each peak is reported as soon as the
+ * falling edge of its QRS region is seen (latency ~ qrsWin/2 + QRS width).
+ * Detection starts once avgWin of signal has been seen. Blocks may be any size.
+ *
+ * @param ctx Streaming context
+ * @param ecg ECG block
+ * @param blockSize Length of ECG block
+ * @param peaks Array of absolute peak indices (sized for blockSize)
+ * @return uint32_t Number of peaks found in this block
+ */
+uint32_t
+pk_ecg_find_peaks_stream_f32(ecg_peak_stream_f32_t *ctx, float32_t *ecg, uint32_t blockSize, uint32_t *peaks);
+
 /**
  * @brief Compute RR intervals from peak indices
  *
@@ -95,17 +230,43 @@ float32_t
 pk_ecg_compute_heart_rate_from_rr_intervals(uint32_t *rrIntervals, uint32_t *mask, uint32_t numPeaks, uint32_t sampleRate);
 
 /**
- * @brief Derive respiratory rate from ECG signal
+ * @brief Get state length (in float32_t) required by ECG-derived respiration
  *
+ * @param ctx EDR context (windowLen, interpRate, maxPeaks must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_ecg_edr_state_size_f32(ecg_edr_f32_t *ctx);
+
+/**
+ * @brief Initialize ECG-derived respiration. Sets up the FFT instance,
+ * interpolation grid and respiratory bandpass once so each window only
+ * touches data.
+ *
+ * @param ctx EDR context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_ecg_init_edr_f32(ecg_edr_f32_t *ctx);
+
+/**
+ * @brief Derive respiratory rate from ECG signal.
+ * RR interval and R-peak amplitude modulation are interpolated onto a uniform
+ * grid, standardized, combined, bandpass filtered to the respiratory band and
+ * the dominant spectral peak is reported. Only the first windowLen secs
+ * following the first valid peak are used.
+ *
+ * @param ctx EDR context
+ * @param ecg ECG signal (peak indices refer to this signal)
  * @param peaks Array of peak indices
  * @param rrIntervals Array of RR intervals
+ * @param mask Filter mask (1 = invalid)
  * @param numPeaks Number of peaks
- * @param sampleRate Sample rate in Hz
  * @param respRate Respiratory rate in BPM
  * @return uint32_t Result code
  */
 uint32_t
-pk_ecg_derive_respiratory_rate(uint32_t *peaks, uint32_t *rrIntervals, uint32_t numPeaks, uint32_t sampleRate, float32_t *respRate);
+pk_ecg_derive_respiratory_rate(ecg_edr_f32_t *ctx, float32_t *ecg, uint32_t *peaks, uint32_t *rrIntervals, uint8_t *mask, uint32_t numPeaks, float32_t *respRate);
 
 #ifdef __cplusplus
 }
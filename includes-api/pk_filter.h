@@ -17,6 +17,33 @@ extern "C" {
 #endif
 
 #include "arm_math.h"
+#include "pk_dsp.h"
+
+#define PK_FILTER_BUTTERWORTH (0)
+#define PK_FILTER_CHEBYSHEV1 (1)
+
+#define PK_FILTER_LOWPASS (0)
+#define PK_FILTER_HIGHPASS (1)
+#define PK_FILTER_BANDPASS (2)
+#define PK_FILTER_BANDSTOP (3)
+
+#ifndef PK_FILTER_DESIGN_CACHE_SIZE
+#define PK_FILTER_DESIGN_CACHE_SIZE (4) // Cached designs (0 disables cache)
+#endif
+#ifndef PK_FILTER_DESIGN_CACHE_SECS
+#define PK_FILTER_DESIGN_CACHE_SECS (8) // Maximum sections of a cached design
+#endif
+
+typedef struct
+{
+    uint8_t family; // PK_FILTER_BUTTERWORTH or PK_FILTER_CHEBYSHEV1
+    uint8_t type; // PK_FILTER_LOWPASS, _HIGHPASS, _BANDPASS or _BANDSTOP
+    uint8_t order; // Filter order
+    float32_t lowcut; // Cutoff (lowpass/highpass) or lower band edge in Hz
+    float32_t highcut; // Upper band edge in Hz (bandpass/bandstop)
+    float32_t ripple; // Passband ripple in dB (Chebyshev I)
+    float32_t sampleRate; // Sample rate in Hz
+} filter_design_f32_t;
 
 typedef struct
 {
@@ -26,31 +53,183 @@ typedef struct
     float32_t *state;
 } biquad_filt_f32_t;
 
+typedef struct
+{
+    uint32_t windowSize; // Window size in samples
+    float32_t *buffer; // Window history requires windowSize
+    uint32_t bufIdx; // Next write position in buffer
+    uint32_t numSamples; // Samples seen (saturates at windowSize)
+    float32_t sum; // Running window sum
+} moving_avg_f32_t;
+
+typedef struct
+{
+    uint32_t upSample; // Upsample factor L
+    uint32_t downSample; // Downsample factor M
+    uint32_t tapsPerPhase; // FIR taps per polyphase branch (16)
+    const float32_t *bank; // Filter bank requires upSample*tapsPerPhase (pk_design_resample_bank_f32), may be shared
+    float32_t *state; // Input history requires pk_resample_state_size_f32(ctx)
+    // Runtime state (set by pk_init_resample_f32)
+    uint32_t phase; // Polyphase branch of next output
+    uint32_t histIdx; // Write position in history
+} resample_f32_t;
+
+typedef struct
+{
+    uint32_t upSample; // Upsample factor L
+    uint32_t downSample; // Downsample factor M
+    uint32_t tapsPerPhase; // Taps per phase of paired pk_resample_signal_f32 to align with (0 = causal)
+    uint32_t *state; // Label history and vote table requires pk_resample_categorical_state_size_u32(ctx)
+    // Runtime state (set by pk_init_resample_categorical_u32)
+    uint32_t histLen; // History length
+    uint32_t histIdx; // Position of newest label in history
+    uint32_t runLen; // Length of run of equal labels ending at newest (saturates at histLen)
+    uint32_t tallyBits; // Log2 of vote table size
+    uint32_t tallyStamp; // Stamp of current vote (table entries with other stamps are empty)
+    uint32_t phase; // Phase of next output
+    int32_t delay; // Group delay in 1/(2L) input samples
+} resample_u32_t;
+
+typedef struct
+{
+    uint32_t srcRate; // Source sample rate in Hz
+    uint32_t dstRate; // Result sample rate in Hz
+    uint8_t cubic; // Use cubic (Catmull-Rom) rather than linear interpolation
+    // Runtime state (set by pk_init_interp_resample_f32)
+    uint32_t phase; // Position of next output past current segment start in 1/dstRate input samples
+    float32_t phaseScale; // 1/dstRate
+    uint32_t numSeen; // Inputs seen (saturates at 4)
+    float32_t hist[4]; // Last four inputs (oldest first)
+} interp_resample_f32_t;
+
+typedef struct
+{
+    uint32_t numStages; // Number of biquad stages
+    const float32_t *coeffs; // Biquad coefficients requires 5*numStages (CMSIS layout)
+    uint32_t hopSize; // Samples finalized per backward pass
+    uint32_t lookahead; // Backward pass settling length in samples
+    float32_t *state; // Internal state requires pk_biquad_filtfilt_stream_state_size_f32(ctx)
+    // Runtime state (set by pk_init_biquad_filtfilt_stream_f32)
+    arm_biquad_casd_df1_inst_f32 fwd; // Forward pass (continuous)
+    arm_biquad_casd_df1_inst_f32 bwd; // Backward pass (per window)
+    float32_t *fwdBuf; // Forward output window requires hopSize + lookahead
+    float32_t *bwdBuf; // Reversed backward output requires hopSize + lookahead
+    uint32_t fwdLen; // Samples in forward window
+    uint32_t readyIdx; // Next finalized sample to emit
+    uint8_t primed; // Forward state initialized
+    uint8_t ready; // Finalized block available
+} biquad_filtfilt_stream_f32_t;
+
 /**
- * @brief Resample signal by upsampling followed by downsamping
+ * @brief Design polyphase filter bank for rational resampling by L/M.
+ * Windowed-sinc (Blackman) lowpass at the lower of the two Nyquist rates with
+ * upSample*tapsPerPhase taps stored branch-major. Factors are reduced by
+ * their GCD. The bank depends only on (L, M, taps) so it can be computed
+ * once (or offline) and shared by every channel.
  *
- * @param pSrc Source signal
- * @param pResult Result signal
- * @param blockSize Block size
- * @param upSample Upsample factor
- * @param downSample Downsample factor
- * @return uint32_t
+ * @param bank Filter bank (upSample*tapsPerPhase)
+ * @param upSample Upsample factor L
+ * @param downSample Downsample factor M
+ * @param tapsPerPhase FIR taps per polyphase branch
+ * @return uint32_t Result code
  */
 uint32_t
-pk_resample_signal_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, uint32_t upSample, uint32_t downSample);
+pk_design_resample_bank_f32(float32_t *bank, uint32_t upSample, uint32_t downSample, uint32_t tapsPerPhase);
 
 /**
- * @brief Resample categorical signal by upsampling followed by downsamping
+ * @brief Get state length (in float32_t) required by streaming polyphase resampler
  *
- * @param pSrc Source signal
- * @param pResult Result signal
- * @param blockSize Block size
- * @param upSample Upsample factor
- * @param downSample Downsample factor
- * @return uint32_t
+ * @param ctx Resampler context (tapsPerPhase must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_resample_state_size_f32(resample_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming polyphase resampler
+ *
+ * @param ctx Resampler context (config, bank and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_resample_f32(resample_f32_t *ctx);
+
+/**
+ * @brief Resample next block of signal by L/M using polyphase FIR.
+ * Only the outputs that are kept are computed and zero-stuffed inputs are
+ * never touched, so cost is tapsPerPhase MACs per output. State carries
+ * across blocks. Group delay is (L*tapsPerPhase - 1)/(2L) input samples.
+ *
+ * @param ctx Resampler context
+ * @param pSrc Source block
+ * @param pResult Result block (sized for ceil(blockSize*L/M) samples)
+ * @param blockSize Length of source block
+ * @return uint32_t Number of output samples
+ */
+uint32_t
+pk_resample_signal_f32(resample_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
+
+/**
+ * @brief Get state length (in uint32_t) required by categorical resampler
+ *
+ * @param ctx Resampler context (upSample, downSample, tapsPerPhase must be set)
+ * @return uint32_t Number of uint32_t elements
+ */
+uint32_t
+pk_resample_categorical_state_size_u32(resample_u32_t *ctx);
+
+/**
+ * @brief Initialize streaming categorical resampler
+ *
+ * @param ctx Resampler context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_resample_categorical_u32(resample_u32_t *ctx);
+
+/**
+ * @brief Resample next block of labels by L/M using integer arithmetic only.
+ * Upsampling picks the nearest label. Downsampling takes the most frequent
+ * label within the output period, breaking ties by the label nearest the
+ * output time. Windows inside a single run of equal labels are copied
+ * through in O(1); others are tallied in one pass over their runs. Outputs are emitted
+ * at the same input steps and times as pk_resample_signal_f32 with matching
+ * L, M and tapsPerPhase, so label and signal streams stay aligned. With
+ * tapsPerPhase = 0 each vote covers the output period ending at the output time.
+ *
+ * @param ctx Resampler context
+ * @param pSrc Source labels
+ * @param pResult Result labels (sized for ceil(blockSize*L/M) samples)
+ * @param blockSize Length of source block
+ * @return uint32_t Number of output samples
+ */
+uint32_t
+pk_resample_categorical_u32(resample_u32_t *ctx, uint32_t *pSrc, uint32_t *pResult, uint32_t blockSize);
+
+/**
+ * @brief Initialize streaming interpolating resampler
+ *
+ * @param ctx Resampler context (config must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_interp_resample_f32(interp_resample_f32_t *ctx);
+
+/**
+ * @brief Resample next block of signal using linear or cubic interpolation.
+ * Phase is an exact rational accumulator (no per-sample floor or divide) so
+ * output k is always at input position k*srcRate/dstRate regardless of how
+ * the input is split into blocks. Latency is one input sample for linear
+ * and two for cubic.
+ *
+ * @param ctx Resampler context
+ * @param pSrc Source block
+ * @param pResult Result block (sized for ceil(blockSize*dstRate/srcRate) samples)
+ * @param blockSize Length of source block
+ * @return uint32_t Number of output samples
  */
 uint32_t
-pk_resample_categorical_u32(uint32_t *pSrc, uint32_t *pResult, uint32_t blockSize, uint32_t upSample, uint32_t downSample);
+pk_interp_resample_f32(interp_resample_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
 
 /**
  * @brief Basic downsampling using linear interpolation
@@ -61,11 +240,37 @@ pk_resample_categorical_u32(uint32_t *pSrc, uint32_t *pResult, uint32_t blockSiz
  * @param pRst Result signal
  * @param rstSize Result size
  * @param rstFs Result sample rate
- * @return uint32_t
+ * @return uint32_t Result code (1 if srcSize or either rate is 0)
  */
 uint32_t
 pk_linear_downsample_f32(float32_t *pSrc, uint32_t srcSize, uint32_t srcFs, float32_t *pRst, uint32_t rstSize, uint32_t rstFs);
 
+/**
+ * @brief Get number of second-order sections of a filter design
+ *
+ * @param design Filter design
+ * @return uint32_t Number of sections (ceil(order/2) lowpass/highpass, order bandpass/bandstop)
+ */
+uint32_t
+pk_filter_design_num_sections(const filter_design_f32_t *design);
+
+/**
+ * @brief Design Butterworth or Chebyshev I filter as second-order sections.
+ * Analog prototype poles are mapped with the bilinear transform (prewarped
+ * edges) and paired into sections ordered by pole radius, furthest from the
+ * unit circle first. Magnitude response matches scipy butter/cheby1
+ * (passband gain 1, or ripple minimum at DC for even order Chebyshev). Recent designs are cached
+ * by parameters so switching sample rates does not recompute them. The
+ * cache is locked on hosted builds (PK_BATCH_THREADS) so designs may be made
+ * from multiple threads.
+ *
+ * @param design Filter design
+ * @param sos Coefficients requires 5*numSections (CMSIS DF1 layout, negated feedback)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_design_biquad_filter_f32(const filter_design_f32_t *design, float32_t *sos);
+
 /**
  * @brief Initialize biqaud filter
  *
@@ -88,18 +293,95 @@ uint32_t
 pk_apply_biquad_filter_f32(arm_biquad_casd_df1_inst_f32 *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
 
 /**
- * @brief Apply biqaud filter to signal forwards and backwards
+ * @brief Initialize multi-channel biquad filter from CMSIS SOS coefficients.
+ * Expands {b0, b1, b2, a1, a2} per stage into the channel-interleaved SoA
+ * layout of ctx->pCoeffs and clears ctx->pState.
+ *
+ * @param ctx Filter context (numChannels, numStages, pCoeffs, pState set)
+ * @param sos Coefficients: 5*numStages shared by all channels, or
+ *  5*numStages per channel back to back when perChannel is set
+ * @param perChannel Non-zero if sos holds one cascade per channel
+ * @return uint32_t
+ */
+uint32_t
+pk_init_biquad_multi_f32(biquad_multi_f32_t *ctx, const float32_t *sos, uint8_t perChannel);
+
+/**
+ * @brief Apply multi-channel biquad filter to interleaved signal
+ *
+ * @param ctx Filter context
+ * @param pSrc Source signal (blockSize*numChannels interleaved)
+ * @param pResult Result signal (may alias pSrc)
+ * @param blockSize Samples per channel
+ * @return uint32_t
+ */
+uint32_t
+pk_apply_biquad_multi_f32(biquad_multi_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
+
+/**
+ * @brief Get state length (in float32_t) required by biquad filtfilt
+ *
+ * @param ctx Filter context
+ * @return uint32_t Number of float32_t elements (edge pad length)
+ */
+uint32_t
+pk_biquad_filtfilt_state_size_f32(arm_biquad_casd_df1_inst_f32 *ctx);
+
+/**
+ * @brief Apply biqaud filter to signal forwards and backwards (zero phase).
+ * Matches scipy sosfiltfilt: signal is odd-extended by 3*(2*numStages + 1)
+ * samples at each end and each pass starts from per-section steady-state
+ * initial conditions, so edges are free of start-up transients. The
+ * backward pass reverses pResult in place (pResult may alias pSrc).
  *
  * @param ctx Filter context
  * @param pSrc Source signal
  * @param pResult Result signal
  * @param blockSize Length of signal
- * @param state Internal state (blockSize)
+ * @param state Internal state requires pk_biquad_filtfilt_state_size_f32(ctx)
  * @return uint32_t Result code
  */
 uint32_t
 pk_apply_biquad_filtfilt_f32(arm_biquad_casd_df1_inst_f32 *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize, float32_t *state);
 
+/**
+ * @brief Get state length (in float32_t) required by streaming filtfilt
+ *
+ * @param ctx Streaming context (numStages, hopSize, lookahead must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_biquad_filtfilt_stream_state_size_f32(biquad_filtfilt_stream_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming zero-phase biquad filter
+ *
+ * @param ctx Streaming context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_biquad_filtfilt_stream_f32(biquad_filtfilt_stream_f32_t *ctx);
+
+/**
+ * @brief Apply zero-phase biquad filter to next block of a live stream.
+ * The forward pass runs continuously. Every hopSize samples the backward
+ * pass runs over the last hopSize + lookahead forward outputs, starting
+ * from steady state, and the oldest hopSize samples are finalized. Output
+ * is delayed by exactly hopSize + lookahead samples (the first outputs are
+ * 0) and costs (1 + lookahead/hopSize) backward passes per sample.
+ * Deviation from offline filtfilt decays with lookahead as the filter's
+ * impulse response (exp(-lookahead/tau), tau of the slowest pole): ~7 tau
+ * gives ~1e-3 relative error (3 s for a 0.5 Hz 2nd order highpass).
+ *
+ * @param ctx Streaming context
+ * @param pSrc Source block
+ * @param pResult Result block (blockSize samples, may alias pSrc)
+ * @param blockSize Length of block
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_apply_biquad_filtfilt_stream_f32(biquad_filtfilt_stream_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
+
 /**
  * @brief Apply quotient filter to signal
  *
@@ -115,18 +397,43 @@ uint32_t
 pk_quotient_filter_mask_u32(uint32_t *data, uint8_t *mask, uint32_t dataLen, uint32_t iterations, float32_t lowcut, float32_t highcut);
 
 /**
- * @brief Smooth signal using moving average
+ * @brief Smooth signal using centered moving average.
+ * Uses a running sum so cost is O(1) per sample regardless of window size.
  *
  * @param pSrc Source signal
- * @param pResult Result signal
- * @param blockSize Length of signal
- * @param wBuffer Window buffer
+ * @param pResult Result signal (must not alias pSrc)
+ * @param blockSize Length of signal (must exceed windowSize)
+ * @param wBuffer Unused, retained for compatibility (may be NULL)
  * @param windowSize Window size
  * @return uint32_t Result code
  */
 uint32_t
 pk_smooth_signal_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, float32_t *wBuffer, uint32_t windowSize);
 
+/**
+ * @brief Initialize streaming moving average
+ *
+ * @param ctx Moving average context (windowSize and buffer must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_moving_average_f32(moving_avg_f32_t *ctx);
+
+/**
+ * @brief Apply causal moving average to next block of signal.
+ * pResult[n] is the mean of the last windowSize samples (fewer during warm-up),
+ * so output lags a centered average by windowSize/2 samples. State carries over
+ * between calls. pSrc and pResult may alias.
+ *
+ * @param ctx Moving average context
+ * @param pSrc Source signal
+ * @param pResult Result signal
+ * @param blockSize Length of block
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_apply_moving_average_f32(moving_avg_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize);
+
 /**
  * @brief Standardize signal: y = (x - mu) / std.
  * Provides safegaurd against small st devs
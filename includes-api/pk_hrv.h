@@ -46,32 +46,132 @@ typedef struct {
 } hrv_td_metrics_t;
 
 typedef struct {
+    // Band power (ms^2)
+    float32_t vlfPower; // 0.0033-0.04 Hz
+    float32_t lfPower; // 0.04-0.15 Hz
+    float32_t hfPower; // 0.15-0.4 Hz
+    float32_t totalPower; // 0.0033-0.4 Hz
+    float32_t lfhfRatio;
+    // Peak frequency (Hz)
+    float32_t vlfPeak;
+    float32_t lfPeak;
+    float32_t hfPeak;
 } hrv_fd_metrics_t;
 
+typedef struct {
+    float32_t windowLen; // Rolling window length in secs (300)
+    uint32_t sampleRate; // Sample rate of RR intervals in Hz
+    uint32_t capacity; // Maximum number of beats held in window
+    uint32_t *state; // Internal state requires 3*capacity
+    // Runtime state (set by pk_hrv_init_stream)
+    uint32_t *rri; // Ring of RR intervals (bit 31 set if masked)
+    uint32_t *minQ; // Monotonic deque of beats for min NN
+    uint32_t *maxQ; // Monotonic deque of beats for max NN
+    uint32_t head; // Sequence number of oldest beat
+    uint32_t tail; // Sequence number of next beat
+    uint32_t minHead, minTail;
+    uint32_t maxHead, maxTail;
+    uint64_t windowTicks; // Window length in ticks
+    uint64_t sumTicks; // Sum of all intervals in window
+    uint32_t numNN; // Valid intervals
+    uint64_t sumNN;
+    uint64_t sumSqNN;
+    uint32_t numSD; // Valid successive differences
+    int64_t sumSD;
+    uint64_t sumSqSD;
+    uint32_t nn20;
+    uint32_t nn50;
+} hrv_td_stream_t;
+
+/**
+ * @brief Get workspace length (in float32_t) required by time domain HRV
+ *
+ * @param numPeaks Number of RR intervals
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_hrv_time_metrics_workspace_size(uint32_t numPeaks);
+
+/**
+ * @brief Compute time domain HRV metrics from RR intervals.
+ * Robust metrics (median, MAD, IQR, percentiles) are exact order statistics
+ * found by in-place selection in scratch. Percentiles use linear
+ * interpolation and MAD is scaled by 1.4826. Min/max NN are in ms over
+ * valid beats.
+ *
+ * @param rrIntervals RR intervals in samples
+ * @param numPeaks Number of RR intervals
+ * @param mask Filter mask (1 = invalid)
+ * @param metrics Time domain metrics
+ * @param sampleRate Sample rate in Hz
+ * @param scratch Scratch buffer requires pk_hrv_time_metrics_workspace_size(numPeaks) (NULL skips robust metrics)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_td_metrics_t *metrics, uint32_t sampleRate, float32_t *scratch);
+
+/**
+ * @brief Initialize streaming time domain HRV
+ *
+ * @param ctx Streaming context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_hrv_init_stream(hrv_td_stream_t *ctx);
+
+/**
+ * @brief Push next RR interval into rolling HRV window.
+ * Sums are kept in integer ticks so each update is O(1) (amortized for min/max).
+ * Beats older than windowLen (or beyond capacity) are evicted.
+ *
+ * @param ctx Streaming context
+ * @param rrInterval RR interval in samples
+ * @param mask Filter mask (1 = invalid)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_hrv_stream_push_rr_interval(hrv_td_stream_t *ctx, uint32_t rrInterval, uint8_t mask);
+
+/**
+ * @brief Get time domain HRV metrics of rolling window.
+ * Matches pk_hrv_compute_time_metrics_from_rr_intervals for deviation,
+ * difference and extrema metrics (min/max in ms over valid beats). Robust
+ * metrics are not tracked and are set to 0.
+ *
+ * @param ctx Streaming context
+ * @param metrics Time domain metrics
+ * @return uint32_t Result code (1 if window has no valid intervals)
+ */
+uint32_t
+pk_hrv_stream_get_time_metrics(hrv_td_stream_t *ctx, hrv_td_metrics_t *metrics);
+
 /**
- * @brief Compute time domain HRV metrics from RR intervals
+ * @brief Get workspace length (in float32_t) required by frequency domain HRV
  *
- * @param rrIntervals
- * @param numPeaks
- * @param mask
- * @param metrics
- * @param sampleRate
- * @return uint32_t
+ * @param freqRes Frequency resolution in Hz
+ * @return uint32_t Number of float32_t elements (0 if freqRes is unsupported)
  */
 uint32_t
-pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_td_metrics_t *metrics, uint32_t sampleRate);
+pk_hrv_freq_metrics_workspace_size(float32_t freqRes);
 
 /**
- * @brief Compute frequency domain HRV metrics from RR intervals
+ * @brief Compute frequency domain HRV metrics from RR intervals.
+ * Uses the fast Lomb-Scargle periodogram (Press & Rybicki) directly on the
+ * unevenly spaced NN series: samples are extirpolated onto a regular grid
+ * and evaluated with two real FFTs, so no resampling step is needed.
+ * Masked intervals are skipped but still advance time.
  *
- * @param rrIntervals
- * @param numPeaks
- * @param mask
- * @param metrics
- * @return uint32_t
+ * @param rrIntervals RR intervals in samples
+ * @param numPeaks Number of RR intervals
+ * @param mask Filter mask (1 = invalid)
+ * @param metrics Frequency domain metrics
+ * @param sampleRate Sample rate in Hz
+ * @param freqRes Frequency resolution in Hz, must be <= 1/duration (1/600 for 5 min with 2x oversampling)
+ * @param workspace Workspace requires pk_hrv_freq_metrics_workspace_size(freqRes)
+ * @return uint32_t Result code
  */
 uint32_t
-pk_hrv_compute_freq_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_fd_metrics_t *metrics);
+pk_hrv_compute_freq_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_fd_metrics_t *metrics, uint32_t sampleRate, float32_t freqRes, float32_t *workspace);
 
 #ifdef __cplusplus
 }
@@ -19,6 +19,53 @@ extern "C" {
 #include <stdint.h>
 #include "arm_math.h"
 
+#define PK_IMU_MATH_EXACT (0) // libm sqrtf/atan2f
+#define PK_IMU_MATH_FAST (1) // Polynomial atan2 and Newton rsqrt (see pk_imu_compute_features_f32)
+
+typedef struct
+{
+    float32_t *enmo; // Output ENMO in g
+    float32_t *xAngle; // Output X-axis tilt angle in rad
+    float32_t *yAngle; // Output Y-axis tilt angle in rad
+    float32_t *zAngle; // Output Z-axis tilt angle in rad
+    float32_t *pitch; // Output pitch angle in rad
+    float32_t *roll; // Output roll angle in rad
+} imu_features_f32_t;
+
+#define PK_IMU_MAX_THRESHOLDS (4) // Maximum ENMO thresholds counted per epoch
+
+typedef struct
+{
+    uint32_t epochIdx; // Epoch number since init
+    float32_t meanEnmo; // Mean ENMO in g
+    float32_t mad; // Mean amplitude deviation of vector magnitude in g
+    uint32_t counts[PK_IMU_MAX_THRESHOLDS]; // Samples with ENMO above each threshold
+    float32_t stillPct; // Percent of still windows in epoch
+} imu_activity_epoch_t;
+
+typedef struct
+{
+    float32_t epochLen; // Epoch length in secs (60)
+    float32_t stillWin; // Stillness window length in secs (1)
+    float32_t stillThresh; // Max vector magnitude std in g for a still window (0.013)
+    float32_t thresholds[PK_IMU_MAX_THRESHOLDS]; // ENMO thresholds in g (e.g. 0.1, 0.4)
+    uint32_t numThresholds; // Number of thresholds used (<= PK_IMU_MAX_THRESHOLDS)
+    uint32_t sampleRate; // Sample rate in Hz
+    float32_t *state; // Internal state requires pk_imu_activity_state_size_f32(ctx)
+    // Runtime state (set by pk_imu_init_activity_f32)
+    uint32_t epochSamples; // Samples per epoch
+    uint32_t stillSamples; // Samples per stillness window
+    uint32_t numSamples; // Samples in current epoch
+    uint32_t epochIdx; // Current epoch number
+    float32_t sumEnmo;
+    uint32_t counts[PK_IMU_MAX_THRESHOLDS];
+    uint32_t stillLen; // Samples in current stillness window
+    float32_t stillSum; // Sum of (magnitude - 1) in current stillness window
+    float32_t stillSumSq;
+    uint32_t numStill; // Still windows in current epoch
+    uint32_t numWins; // Completed windows in current epoch
+} imu_activity_f32_t;
+
 /**
  * @brief Compute ENMO from accelerometer data
  *
@@ -61,6 +108,62 @@ pk_imu_compute_tilt_angles_f32(float32_t *x, float32_t *y, float32_t *z, float32
 uint32_t
 pk_imu_compute_pitch_roll_f32(float32_t *x, float32_t *y, float32_t *z, float32_t *pitch, float32_t *roll, uint32_t blockSize);
 
+/**
+ * @brief Compute ENMO, tilt angles, pitch and roll in a single fused pass.
+ * Squares are formed once per sample and pitch reuses the x tilt angle.
+ * Matches pk_imu_compute_enmo_f32, pk_imu_compute_tilt_angles_f32 and
+ * pk_imu_compute_pitch_roll_f32. PK_IMU_MATH_FAST replaces libm with a
+ * degree-11 odd minimax atan (max error 5e-6 rad) and a two-step Newton
+ * rsqrt (max relative error 5e-6), branch-free so the loop vectorizes.
+ *
+ * @param x X-axis accelerometer data
+ * @param y Y-axis accelerometer data
+ * @param z Z-axis accelerometer data
+ * @param features Output arrays (all must be set and must not overlap inputs)
+ * @param blockSize Number of samples
+ * @param mathMode PK_IMU_MATH_EXACT or PK_IMU_MATH_FAST
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_imu_compute_features_f32(float32_t *x, float32_t *y, float32_t *z, imu_features_f32_t *features, uint32_t blockSize, uint32_t mathMode);
+
+/**
+ * @brief Get state length (in float32_t) required by streaming activity
+ * aggregation (one epoch of vector magnitude)
+ *
+ * @param ctx Activity context (epochLen, sampleRate must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_imu_activity_state_size_f32(imu_activity_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming activity aggregation
+ *
+ * @param ctx Activity context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_imu_init_activity_f32(imu_activity_f32_t *ctx);
+
+/**
+ * @brief Push next block of accelerometer data and emit a record for every
+ * epoch it completes. Memory is fixed by epoch length, not recording length,
+ * so raw samples can be dropped once pushed. Stillness windows are still
+ * when the std of vector magnitude is below stillThresh; a trailing partial
+ * window in an epoch is ignored.
+ *
+ * @param ctx Activity context
+ * @param x X-axis accelerometer data in g
+ * @param y Y-axis accelerometer data in g
+ * @param z Z-axis accelerometer data in g
+ * @param blockSize Number of samples
+ * @param epochs Completed epoch records (sized for blockSize / epochSamples + 1)
+ * @return uint32_t Number of epochs emitted
+ */
+uint32_t
+pk_imu_activity_push_f32(imu_activity_f32_t *ctx, float32_t *x, float32_t *y, float32_t *z, uint32_t blockSize, imu_activity_epoch_t *epochs);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,9 +18,66 @@ extern "C" {
 
 #include "arm_math.h"
 
+typedef struct
+{
+    float32_t *x; // Knots (strictly increasing)
+    float32_t *y; // Values at knots
+    uint32_t xLen; // Number of knots (>= 2)
+    float32_t *state; // Internal state requires pk_spline_state_size_f32(ctx)
+    // Runtime state (set by pk_init_spline_f32)
+    float32_t *b; // Per segment linear coefficient
+    float32_t *c; // Per segment quadratic coefficient
+    float32_t *d; // Per segment cubic coefficient
+} spline_f32_t;
+
+/**
+ * @brief Linear interpolation of (x, y) at xNew, extrapolating the end segments.
+ * Increasing runs of xNew are merge-walked against x (O(xLen + xNewLen)) with
+ * each segment slope computed once; any step back falls back to binary search.
+ *
+ * @param x Known x values (increasing)
+ * @param y Known y values
+ * @param xLen Number of known values
+ * @param xNew New x values
+ * @param yNew Interpolated y values
+ * @param xNewLen Number of new values
+ */
 void
 pk_inter1d_f32(float32_t *x, float32_t *y, uint32_t xLen, float32_t *xNew, float32_t *yNew, uint32_t xNewLen);
 
+/**
+ * @brief Get state length (in float32_t) required by cubic spline
+ *
+ * @param ctx Spline context (xLen must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_spline_state_size_f32(spline_f32_t *ctx);
+
+/**
+ * @brief Initialize natural cubic spline through knots (x, y).
+ * Solves the tridiagonal system for knot curvatures once in O(xLen) and
+ * stores per segment polynomial coefficients for evaluation.
+ *
+ * @param ctx Spline context (x, y, xLen and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_spline_f32(spline_f32_t *ctx);
+
+/**
+ * @brief Evaluate cubic spline at xNew (end polynomials extrapolate).
+ * Same segment search as pk_inter1d_f32; each point is a 3 FMA Horner step.
+ *
+ * @param ctx Spline context
+ * @param xNew New x values
+ * @param yNew Interpolated y values
+ * @param xNewLen Number of new values
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_spline_eval_f32(spline_f32_t *ctx, float32_t *xNew, float32_t *yNew, uint32_t xNewLen);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,6 +16,9 @@ extern "C" {
 #endif
 
 #include "arm_math.h"
+#include "pk_filter.h"
+
+#define PK_PPG_STREAM_CHUNK (32) // Samples processed per internal chunk in streaming mode
 
 typedef struct
 {
@@ -24,11 +27,52 @@ typedef struct
     float32_t beatOffset; // 0.02
     float32_t peakDelayWin; // 0.3
     uint32_t sampleRate;
-    // State requires 4*ppgLen
+    // State requires pk_ppg_peak_state_size_f32(ctx, ppgLen)
     float32_t *state;
     uint32_t *peaks;
 } ppg_peak_f32_t;
 
+typedef struct
+{
+    float32_t peakWin; // 0.111
+    float32_t beatWin; // 0.667
+    float32_t beatOffset; // 0.02
+    float32_t peakDelayWin; // 0.3
+    float32_t meanWin; // Time constant of running squared mean in secs (8.0)
+    uint32_t sampleRate;
+    // State requires pk_ppg_peak_stream_state_size_f32(ctx)
+    float32_t *state;
+    // Runtime state (set by pk_ppg_init_peak_stream_f32)
+    moving_avg_f32_t peakAvg; // Peak moving average
+    moving_avg_f32_t beatAvg; // Beat moving average
+    float32_t *sqrdBuf; // Delayed squared signal
+    uint32_t sqrdBufLen;
+    uint32_t beatDelay; // Group delay of beat moving average in samples
+    uint32_t peakLag; // Extra delay applied to peak moving average input
+    uint32_t minPeakDelay;
+    uint32_t minPeakWidth;
+    float32_t muSqrd; // Running mean of squared signal
+    float32_t muAlpha; // Running mean update rate
+    float32_t prevDiff;
+    uint32_t numSamples; // Total samples consumed
+    uint8_t inPeak;
+    uint32_t peakStart; // Absolute index of current rising edge
+    float32_t peakVal;
+    uint32_t peakIdx;
+    uint8_t hasPeak;
+    uint32_t lastPeak; // Absolute index of last emitted peak
+} ppg_peak_stream_f32_t;
+
+/**
+ * @brief Get state length (in float32_t) required by PPG peak detector
+ *
+ * @param ctx PPG context
+ * @param ppgLen Length of PPG signal
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_ppg_peak_state_size_f32(ppg_peak_f32_t *ctx, uint32_t ppgLen);
+
 /**
  * @brief Find peaks in PPG signal
  *
@@ -36,11 +80,45 @@ typedef struct
  * @param ppg PPG signal
  * @param ppgLen Length of PPG signal
  * @param peaks Array of peak indices
- * @return uint32_t
+ * @return uint32_t Number of peaks (0 if signal is not longer than the peak and beat windows)
  */
 uint32_t
 pk_ppg_find_peaks_f32(ppg_peak_f32_t* ctx, float32_t *ppg, uint32_t ppgLen, uint32_t *peaks);
 
+/**
+ * @brief Get state length (in float32_t) required by streaming PPG peak detector
+ *
+ * @param ctx Streaming context (peakWin, beatWin, sampleRate must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_ppg_peak_stream_state_size_f32(ppg_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming PPG peak detector
+ *
+ * @param ctx Streaming context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_ppg_init_peak_stream_f32(ppg_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Find peaks in next block of PPG signal.
+ * Same detector as pk_ppg_find_peaks_f32 but the beat offset uses a running
+ * (exponential) mean of the squared signal. Peaks are reported once, with
+ * absolute indices, about beatWin/2 after their falling edge. Detection starts
+ * once beatWin of signal has been seen. Blocks may be any size.
+ *
+ * @param ctx Streaming context
+ * @param ppg PPG block
+ * @param blockSize Length of PPG block
+ * @param peaks Array of absolute peak indices (sized for blockSize)
+ * @return uint32_t Number of peaks found in this block
+ */
+uint32_t
+pk_ppg_find_peaks_stream_f32(ppg_peak_stream_f32_t *ctx, float32_t *ppg, uint32_t blockSize, uint32_t *peaks);
+
 /**
  * @brief Compute RR intervals from peak indices
  *
@@ -17,6 +17,10 @@ extern "C" {
 #endif
 
 #include "arm_math.h"
+#include "pk_filter.h"
+
+#define PK_RSP_STREAM_CHUNK (32) // Samples processed per internal chunk in streaming mode
+#define PK_RSP_STREAM_RATE_LEN (8) // Number of breaths averaged for streaming respiratory rate
 
 typedef struct
 {
@@ -25,10 +29,56 @@ typedef struct
     float32_t breathOffset; // Breath offset in sec (0.05)
     float32_t peakDelayWin; // Successive breah delay in sec (0.3)
     uint32_t sampleRate; // Sample rate in Hz
-    float32_t *state; // Internal state requires 4*rspLen
+    float32_t *state; // Internal state requires pk_rsp_peak_state_size_f32(ctx, rspLen)
     uint32_t *peaks; // Array of peak indices
 } rsp_peak_f32_t;
 
+typedef struct
+{
+    float32_t peakWin; // Peak window length in sec (0.5)
+    float32_t breathWin; // Breath window length in sec (2.0)
+    float32_t breathOffset; // Breath offset in sec (0.05)
+    float32_t peakDelayWin; // Successive breah delay in sec (0.3)
+    float32_t meanWin; // Time constant of running squared mean in secs (30.0)
+    uint32_t sampleRate; // Sample rate in Hz
+    float32_t *state; // Internal state requires pk_rsp_peak_stream_state_size_f32(ctx)
+    // Runtime state (set by pk_rsp_init_peak_stream_f32)
+    moving_avg_f32_t peakAvg; // Peak moving average
+    moving_avg_f32_t breathAvg; // Breath moving average
+    float32_t *sqrdBuf; // Delayed squared signal
+    float32_t *rspBuf; // Delayed RSP signal used to locate peak
+    uint32_t bufLen;
+    uint32_t breathDelay; // Group delay of breath moving average in samples
+    uint32_t peakLag; // Extra delay applied to peak moving average input
+    uint32_t minPeakDelay;
+    uint32_t minPeakWidth;
+    float32_t muSqrd; // Running mean of squared signal
+    float32_t muAlpha; // Running mean update rate
+    float32_t prevDiff;
+    uint32_t numSamples; // Total samples consumed
+    uint8_t inPeak;
+    uint32_t peakStart; // Absolute index of current rising edge
+    float32_t peakVal;
+    uint32_t peakIdx;
+    uint8_t hasPeak;
+    uint32_t lastPeak; // Absolute index of last emitted peak
+    float32_t rates[PK_RSP_STREAM_RATE_LEN]; // Recent per-breath rates in BPM
+    uint32_t rateIdx;
+    uint32_t numRates;
+    float32_t rateSum;
+    float32_t respRateBpm; // Respiratory rate over recent breaths in BPM
+} rsp_peak_stream_f32_t;
+
+/**
+ * @brief Get state length (in float32_t) required by RSP peak detector
+ *
+ * @param ctx RSP context
+ * @param rspLen Length of RSP signal
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_rsp_peak_state_size_f32(rsp_peak_f32_t *ctx, uint32_t rspLen);
+
 /**
  * @brief Find peaks in RSP signal
  *
@@ -36,11 +86,49 @@ typedef struct
  * @param rsp RSP signal
  * @param rspLen Length of RSP signal
  * @param peaks Array of peak indices
- * @return uint32_t
+ * @return uint32_t Number of peaks (0 if signal is not longer than the peak and breath windows)
  */
 uint32_t
 pk_rsp_find_peaks_f32(rsp_peak_f32_t* ctx, float32_t *rsp, uint32_t rspLen, uint32_t *peaks);
 
+/**
+ * @brief Get state length (in float32_t) required by streaming RSP peak detector
+ *
+ * @param ctx Streaming context (peakWin, breathWin, sampleRate must be set)
+ * @return uint32_t Number of float32_t elements
+ */
+uint32_t
+pk_rsp_peak_stream_state_size_f32(rsp_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Initialize streaming RSP peak detector
+ *
+ * @param ctx Streaming context (config and state must be set)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_rsp_init_peak_stream_f32(rsp_peak_stream_f32_t *ctx);
+
+/**
+ * @brief Find breath peaks in next block of RSP signal.
+ * Same detector as pk_rsp_find_peaks_f32 but the breath offset uses a running
+ * (exponential) mean of the squared signal. Peaks are reported once, with
+ * absolute indices, about breathWin/2 after their falling edge. For every
+ * breath the interval to the previous breath is returned and ctx->respRateBpm
+ * is updated with the mean rate of the last PK_RSP_STREAM_RATE_LEN breaths in
+ * breaths per minute (pk_rsp_compute_respiratory_rate_from_rr_intervals
+ * returns breaths per second).
+ *
+ * @param ctx Streaming context
+ * @param rsp RSP block
+ * @param blockSize Length of RSP block
+ * @param peaks Array of absolute peak indices (sized for blockSize)
+ * @param rrIntervals Array of breath intervals in samples, 0 for first breath (may be NULL)
+ * @return uint32_t Number of peaks found in this block
+ */
+uint32_t
+pk_rsp_find_peaks_stream_f32(rsp_peak_stream_f32_t *ctx, float32_t *rsp, uint32_t blockSize, uint32_t *peaks, uint32_t *rrIntervals);
+
 /**
  * @brief Compute RR intervals from peak indices
  *
@@ -74,7 +162,7 @@ pk_rsp_filter_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *ma
  * @param mask Filter mask (1 = outside of range, 0 = inside of range)
  * @param numPeaks Number of peaks
  * @param sampleRate Sample rate in Hz
- * @return float32_t
+ * @return float32_t Mean respiratory rate in breaths per second
  */
 float32_t
 pk_rsp_compute_respiratory_rate_from_rr_intervals(uint32_t *rrIntervals, uint32_t *mask, uint32_t numPeaks, uint32_t sampleRate);
@@ -18,9 +18,140 @@ extern "C" {
 
 #include "arm_math.h"
 
+#define PK_RADIX_BITS (8) // Bits per radix sort pass
+#define PK_EYTZINGER_GROUP (8) // Queries descended in lockstep by batch search
+
+typedef struct
+{
+    uint32_t len; // Number of sorted values
+    float32_t *tree; // Values in Eytzinger (BFS) order requires pk_eytzinger_state_size_f32(len)
+    uint32_t *rank; // Sorted index of each tree node requires pk_eytzinger_state_size_f32(len)
+    // Runtime state (set by pk_init_eytzinger_f32)
+    uint32_t levels; // Tree depth
+} eytzinger_f32_t;
+
 size_t
 pk_binary_search_f32(float32_t *x, size_t xLen, float32_t xNew);
 
+/**
+ * @brief Get workspace length (in uint32_t) required by radix sort
+ *
+ * @param len Number of keys
+ * @param hasIndex Non-zero if an index payload is sorted along with keys
+ * @return uint32_t Number of uint32_t elements
+ */
+uint32_t
+pk_radix_sort_workspace_size(uint32_t len, uint8_t hasIndex);
+
+/**
+ * @brief Get workspace length (in uint32_t) required by float32_t radix sort.
+ * Unsigned keys are built in the workspace, not over the caller's values.
+ *
+ * @param len Number of values
+ * @param hasIndex Non-zero if an index payload is sorted along with values
+ * @return uint32_t Number of uint32_t elements
+ */
+uint32_t
+pk_radix_sort_workspace_size_f32(uint32_t len, uint8_t hasIndex);
+
+/**
+ * @brief Stable LSD radix sort of uint32_t keys in-place, O(n) per pass.
+ * Passes whose digit is the same for every key are skipped, so small keys
+ * (e.g. RR intervals, peak indices) take fewer passes.
+ *
+ * @param keys Keys (sorted in-place)
+ * @param indices Payload permuted along with keys, e.g. 0..len-1 for argsort (may be NULL)
+ * @param len Number of keys
+ * @param workspace Workspace requires pk_radix_sort_workspace_size(len, indices != NULL)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_radix_sort_u32(uint32_t *keys, uint32_t *indices, uint32_t len, uint32_t *workspace);
+
+/**
+ * @brief Stable radix sort of float32_t values in-place.
+ * Values are mapped to order-preserving unsigned keys so the result matches
+ * an ascending comparison sort (-0 before +0, NaNs at the ends by sign).
+ *
+ * @param x Values (sorted in-place)
+ * @param indices Payload permuted along with values (may be NULL)
+ * @param len Number of values
+ * @param workspace Workspace requires pk_radix_sort_workspace_size_f32(len, indices != NULL)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_radix_sort_f32(float32_t *x, uint32_t *indices, uint32_t len, uint32_t *workspace);
+
+/**
+ * @brief Get length of each Eytzinger buffer (tree and rank), including node 0
+ *
+ * @param len Number of sorted values
+ * @return uint32_t Number of elements
+ */
+uint32_t
+pk_eytzinger_state_size_f32(uint32_t len);
+
+/**
+ * @brief Build Eytzinger layout of sorted values for branchless search
+ *
+ * @param ctx Search context (len, tree and rank must be set)
+ * @param x Sorted values (ascending)
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_init_eytzinger_f32(eytzinger_f32_t *ctx, const float32_t *x);
+
+/**
+ * @brief Branchless lower bound: index of first sorted value >= xNew.
+ * Every query descends the same number of levels with no data dependent
+ * branches; the tree top stays cache resident.
+ *
+ * @param ctx Search context
+ * @param xNew Query value
+ * @return uint32_t Index in sorted values (len if all values < xNew)
+ */
+uint32_t
+pk_eytzinger_lower_bound_f32(eytzinger_f32_t *ctx, float32_t xNew);
+
+/**
+ * @brief Batched branchless lower bound. Queries are descended in lockstep
+ * groups so their memory accesses overlap.
+ *
+ * @param ctx Search context
+ * @param xNew Query values (any order)
+ * @param idx Index in sorted values of each query
+ * @param numQueries Number of queries
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_eytzinger_lower_bound_batch_f32(eytzinger_f32_t *ctx, const float32_t *xNew, uint32_t *idx, uint32_t numQueries);
+
+/**
+ * @brief Select multiple order statistics in-place (introselect).
+ * On return x[ranks[i]] holds the value it would have if x were sorted and
+ * x is partitioned around each rank. All ranks share partitioning passes.
+ * Expected O(n), worst case O(n log n).
+ *
+ * @param x Values (reordered in-place)
+ * @param xLen Number of values
+ * @param ranks Zero-based ranks in ascending order
+ * @param numRanks Number of ranks
+ * @return uint32_t Result code
+ */
+uint32_t
+pk_multiselect_f32(float32_t *x, size_t xLen, const size_t *ranks, size_t numRanks);
+
+/**
+ * @brief Select k-th smallest value in-place (introselect)
+ *
+ * @param x Values (reordered in-place)
+ * @param xLen Number of values
+ * @param k Zero-based rank
+ * @return float32_t k-th smallest value
+ */
+float32_t
+pk_select_f32(float32_t *x, size_t xLen, size_t k);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,74 @@
+/**
+ * @file pk_arena.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Scratch arena
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdint.h>
+#include "arm_math.h"
+
+#include "pk_arena.h"
+
+uint32_t
+pk_arena_init(pk_arena_t *arena, void *buffer, uint32_t size)
+{
+    if (buffer == NULL && size > 0)
+    {
+        return 1;
+    }
+    arena->buffer = (uint8_t *)buffer;
+    arena->size = size;
+    arena->used = 0;
+    arena->peak = 0;
+    return 0;
+}
+
+void *
+pk_arena_alloc(pk_arena_t *arena, uint32_t size)
+{
+    // Align absolute address so any buffer alignment is handled
+    uintptr_t base = (uintptr_t)arena->buffer;
+    uintptr_t addr = (base + arena->used + PK_ARENA_ALIGN - 1) & ~(uintptr_t)(PK_ARENA_ALIGN - 1);
+    uint32_t offset = (uint32_t)(addr - base);
+    if (offset > arena->size || size > arena->size - offset)
+    {
+        return NULL;
+    }
+    arena->used = offset + size;
+    if (arena->used > arena->peak)
+    {
+        arena->peak = arena->used;
+    }
+    return &arena->buffer[offset];
+}
+
+float32_t *
+pk_arena_alloc_f32(pk_arena_t *arena, uint32_t len)
+{
+    if (len > UINT32_MAX / sizeof(float32_t))
+    {
+        return NULL;
+    }
+    return (float32_t *)pk_arena_alloc(arena, len * sizeof(float32_t));
+}
+
+uint32_t
+pk_arena_mark(pk_arena_t *arena)
+{
+    return arena->used;
+}
+
+uint32_t
+pk_arena_release(pk_arena_t *arena, uint32_t mark)
+{
+    if (mark > arena->used)
+    {
+        return 1;
+    }
+    arena->used = mark;
+    return 0;
+}
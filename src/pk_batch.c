@@ -0,0 +1,191 @@
+/**
+ * @file pk_batch.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: Batch processing
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <string.h>
+#include "arm_math.h"
+
+#include "pk_ecg.h"
+#include "pk_hrv.h"
+#include "pk_batch.h"
+
+#if PK_BATCH_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+typedef atomic_uint pk_batch_cursor_t;
+#define PK_BATCH_FETCH_ADD(p, v) atomic_fetch_add_explicit((p), (v), memory_order_relaxed)
+#else
+typedef uint32_t pk_batch_cursor_t;
+#define PK_BATCH_FETCH_ADD(p, v) ((*(p) += (v)) - (v))
+#endif
+
+typedef struct
+{
+    batch_ecg_hrv_f32_t *ctx;
+    const batch_ecg_record_f32_t *records;
+    uint32_t numRecords;
+    batch_ecg_hrv_result_f32_t *results;
+    pk_batch_cursor_t cursor; // Next unclaimed record
+    pk_batch_cursor_t errors; // Records exceeding maxLen
+} pk_batch_ecg_hrv_job_t;
+
+typedef struct
+{
+    pk_batch_ecg_hrv_job_t *job;
+    float32_t *state; // Worker slice of ctx->state
+} pk_batch_ecg_hrv_worker_t;
+
+static uint32_t
+pk_batch_ecg_hrv_max_peaks(batch_ecg_hrv_f32_t *ctx)
+{
+    // Successive peaks are at least minQrsDelay apart
+    uint32_t minQrsDelay = (uint32_t)(ctx->peak.sampleRate * ctx->peak.qrsDelayWin + 1);
+    return ctx->maxLen / minQrsDelay + 1;
+}
+
+static uint32_t
+pk_batch_ecg_hrv_worker_size(batch_ecg_hrv_f32_t *ctx)
+{
+    uint32_t peakStateLen = pk_ecg_peak_state_size_f32(&ctx->peak);
+    uint32_t maxPeaks = pk_batch_ecg_hrv_max_peaks(ctx);
+    // Peak state, peaks, rri, HRV scratch, mask (uint8_t packed 4 per element)
+    return peakStateLen + 2 * maxPeaks + pk_hrv_time_metrics_workspace_size(maxPeaks) + (maxPeaks + 3) / 4;
+}
+
+uint32_t
+pk_batch_ecg_hrv_state_size_f32(batch_ecg_hrv_f32_t *ctx)
+{
+    uint32_t numThreads = ctx->numThreads > 0 ? ctx->numThreads : 1;
+    return numThreads * pk_batch_ecg_hrv_worker_size(ctx);
+}
+
+#define PK_BATCH_STORE(field, val)         \
+    if (results->field != NULL)            \
+    {                                      \
+        results->field[idx] = (val);       \
+    }
+
+static void
+pk_batch_ecg_hrv_store(batch_ecg_hrv_result_f32_t *results, uint32_t idx, uint32_t numPeaks, uint32_t numValid, hrv_td_metrics_t *m)
+{
+    PK_BATCH_STORE(numPeaks, numPeaks);
+    PK_BATCH_STORE(numValid, numValid);
+    PK_BATCH_STORE(meanNN, m->meanNN);
+    PK_BATCH_STORE(sdNN, m->sdNN);
+    PK_BATCH_STORE(rmsSD, m->rmsSD);
+    PK_BATCH_STORE(sdSD, m->sdSD);
+    PK_BATCH_STORE(cvNN, m->cvNN);
+    PK_BATCH_STORE(cvSD, m->cvSD);
+    PK_BATCH_STORE(medianNN, m->medianNN);
+    PK_BATCH_STORE(madNN, m->madNN);
+    PK_BATCH_STORE(mcvNN, m->mcvNN);
+    PK_BATCH_STORE(iqrNN, m->iqrNN);
+    PK_BATCH_STORE(prc20NN, m->prc20NN);
+    PK_BATCH_STORE(prc80NN, m->prc80NN);
+    PK_BATCH_STORE(nn50, m->nn50);
+    PK_BATCH_STORE(nn20, m->nn20);
+    PK_BATCH_STORE(pnn50, m->pnn50);
+    PK_BATCH_STORE(pnn20, m->pnn20);
+    PK_BATCH_STORE(minNN, m->minNN);
+    PK_BATCH_STORE(maxNN, m->maxNN);
+}
+
+static uint32_t
+pk_batch_ecg_hrv_record(batch_ecg_hrv_f32_t *ctx, float32_t *state, const batch_ecg_record_f32_t *rec, batch_ecg_hrv_result_f32_t *results, uint32_t idx)
+{
+    uint32_t peakStateLen = pk_ecg_peak_state_size_f32(&ctx->peak);
+    uint32_t maxPeaks = pk_batch_ecg_hrv_max_peaks(ctx);
+    uint32_t *peaks = (uint32_t *)&state[peakStateLen];
+    uint32_t *rri = &peaks[maxPeaks];
+    float32_t *scratch = &state[peakStateLen + 2 * maxPeaks];
+    uint8_t *mask = (uint8_t *)&scratch[pk_hrv_time_metrics_workspace_size(maxPeaks)];
+
+    ecg_peak_f32_t peakCtx = ctx->peak;
+    peakCtx.state = state;
+
+    hrv_td_metrics_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    uint32_t numPeaks = 0, numValid = 0;
+    if (rec->ecgLen > ctx->maxLen)
+    {
+        pk_batch_ecg_hrv_store(results, idx, 0, 0, &metrics);
+        return 1;
+    }
+    numPeaks = pk_ecg_find_peaks_f32(&peakCtx, rec->ecg, rec->ecgLen, peaks, NULL);
+    pk_ecg_compute_rr_intervals(peaks, numPeaks, rri);
+    pk_ecg_filter_rr_intervals(rri, numPeaks, mask, peakCtx.sampleRate, ctx->minRR, ctx->maxRR, ctx->minDelta);
+    for (size_t i = 0; i < numPeaks; i++)
+    {
+        numValid += mask[i] == 0;
+    }
+    if (numValid > 0)
+    {
+        pk_hrv_compute_time_metrics_from_rr_intervals(rri, numPeaks, mask, &metrics, peakCtx.sampleRate, scratch);
+    }
+    pk_batch_ecg_hrv_store(results, idx, numPeaks, numValid, &metrics);
+    return 0;
+}
+
+static void *
+pk_batch_ecg_hrv_worker(void *arg)
+{
+    pk_batch_ecg_hrv_worker_t *worker = (pk_batch_ecg_hrv_worker_t *)arg;
+    pk_batch_ecg_hrv_job_t *job = worker->job;
+    uint32_t start, end;
+    while ((start = PK_BATCH_FETCH_ADD(&job->cursor, PK_BATCH_CHUNK)) < job->numRecords)
+    {
+        end = start + PK_BATCH_CHUNK < job->numRecords ? start + PK_BATCH_CHUNK : job->numRecords;
+        for (uint32_t i = start; i < end; i++)
+        {
+            if (pk_batch_ecg_hrv_record(job->ctx, worker->state, &job->records[i], job->results, i))
+            {
+                PK_BATCH_FETCH_ADD(&job->errors, 1);
+            }
+        }
+    }
+    return NULL;
+}
+
+uint32_t
+pk_batch_ecg_hrv_f32(batch_ecg_hrv_f32_t *ctx, const batch_ecg_record_f32_t *records, uint32_t numRecords, batch_ecg_hrv_result_f32_t *results)
+{
+    uint32_t numThreads = ctx->numThreads > 0 ? ctx->numThreads : 1;
+    uint32_t workerSize = pk_batch_ecg_hrv_worker_size(ctx);
+    if (numThreads > PK_BATCH_MAX_THREADS)
+    {
+        return 1;
+    }
+    pk_batch_ecg_hrv_job_t job = {.ctx = ctx, .records = records, .numRecords = numRecords, .results = results};
+    pk_batch_ecg_hrv_worker_t workers[PK_BATCH_MAX_THREADS];
+    for (size_t t = 0; t < numThreads; t++)
+    {
+        workers[t].job = &job;
+        workers[t].state = &ctx->state[t * workerSize];
+    }
+#if PK_BATCH_THREADS
+    pthread_t threads[PK_BATCH_MAX_THREADS];
+    uint8_t started[PK_BATCH_MAX_THREADS];
+    for (size_t t = 1; t < numThreads; t++)
+    {
+        // Caller picks up the slack if a thread cannot be created
+        started[t] = pthread_create(&threads[t], NULL, pk_batch_ecg_hrv_worker, &workers[t]) == 0;
+    }
+    pk_batch_ecg_hrv_worker(&workers[0]);
+    for (size_t t = 1; t < numThreads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(threads[t], NULL);
+        }
+    }
+#else
+    pk_batch_ecg_hrv_worker(&workers[0]);
+#endif
+    return job.errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,444 @@
+/**
+ * @file pk_dsp.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: DSP backend
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <math.h>
+#include "arm_math.h"
+
+#include "pk_dsp.h"
+#include "pk_dsp_internal.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef const pk_dsp_backend_t *_Atomic pk_dsp_backend_ptr_t;
+#define PK_DSP_LOAD(p) atomic_load_explicit((p), memory_order_acquire)
+#define PK_DSP_STORE(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#define PK_DSP_CAS(p, e, v) atomic_compare_exchange_strong_explicit((p), (e), (v), memory_order_acq_rel, memory_order_acquire)
+#else
+typedef const pk_dsp_backend_t *volatile pk_dsp_backend_ptr_t;
+#define PK_DSP_LOAD(p) (*(p))
+#define PK_DSP_STORE(p, v) (*(p) = (v))
+#define PK_DSP_CAS(p, e, v) (*(p) == *(e) ? (*(p) = (v), 1) : (*(e) = *(p), 0))
+#endif
+
+/******************************************************************************
+ * CMSIS backend
+ ******************************************************************************/
+
+static void
+pk_dsp_cmsis_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult)
+{
+    arm_dot_prod_f32((float32_t *)pSrcA, (float32_t *)pSrcB, blockSize, pResult);
+}
+
+static void
+pk_dsp_cmsis_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    arm_max_f32((float32_t *)pSrc, blockSize, pResult, pIndex);
+}
+
+static void
+pk_dsp_cmsis_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    arm_mean_f32((float32_t *)pSrc, blockSize, pResult);
+}
+
+static void
+pk_dsp_cmsis_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    arm_var_f32((float32_t *)pSrc, blockSize, pResult);
+}
+
+static void
+pk_dsp_cmsis_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    arm_rms_f32((float32_t *)pSrc, blockSize, pResult);
+}
+
+static void
+pk_dsp_cmsis_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    arm_abs_f32((float32_t *)pSrc, pDst, blockSize);
+}
+
+static void
+pk_dsp_cmsis_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    arm_scale_f32((float32_t *)pSrc, scale, pDst, blockSize);
+}
+
+static void
+pk_dsp_cmsis_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize)
+{
+    arm_offset_f32((float32_t *)pSrc, offset, pDst, blockSize);
+}
+
+static void
+pk_dsp_cmsis_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    arm_sub_f32((float32_t *)pSrcA, (float32_t *)pSrcB, pDst, blockSize);
+}
+
+static void
+pk_dsp_cmsis_biquad_df1_f32(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    arm_biquad_cascade_df1_f32(ctx, (float32_t *)pSrc, pDst, blockSize);
+}
+
+// No CMSIS multi-channel biquad; the reference loop vectorizes across channels (MVE/Helium)
+static const pk_dsp_backend_t pkDspBackendCmsis = {
+    .name = "cmsis",
+    .dot_prod = pk_dsp_cmsis_dot_prod_f32,
+    .max = pk_dsp_cmsis_max_f32,
+    .mean = pk_dsp_cmsis_mean_f32,
+    .var = pk_dsp_cmsis_var_f32,
+    .rms = pk_dsp_cmsis_rms_f32,
+    .abs = pk_dsp_cmsis_abs_f32,
+    .scale = pk_dsp_cmsis_scale_f32,
+    .offset = pk_dsp_cmsis_offset_f32,
+    .sub = pk_dsp_cmsis_sub_f32,
+    .biquad_df1 = pk_dsp_cmsis_biquad_df1_f32,
+    .biquad_df1_multi = pk_dsp_ref_biquad_df1_multi_f32,
+};
+
+/******************************************************************************
+ * Portable reference backend
+ ******************************************************************************/
+
+static void
+pk_dsp_ref_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum = 0;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        sum += pSrcA[i] * pSrcB[i];
+    }
+    *pResult = sum;
+}
+
+static void
+pk_dsp_ref_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    float32_t maxVal = pSrc[0];
+    uint32_t maxIdx = 0;
+    for (size_t i = 1; i < blockSize; i++)
+    {
+        if (pSrc[i] > maxVal)
+        {
+            maxVal = pSrc[i];
+            maxIdx = i;
+        }
+    }
+    *pResult = maxVal;
+    *pIndex = maxIdx;
+}
+
+static void
+pk_dsp_ref_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum = 0;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        sum += pSrc[i];
+    }
+    *pResult = sum / blockSize;
+}
+
+static void
+pk_dsp_ref_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t mu, d, sum = 0;
+    if (blockSize <= 1)
+    {
+        *pResult = 0;
+        return;
+    }
+    pk_dsp_ref_mean_f32(pSrc, blockSize, &mu);
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        d = pSrc[i] - mu;
+        sum += d * d;
+    }
+    *pResult = sum / (blockSize - 1);
+}
+
+static void
+pk_dsp_ref_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum;
+    pk_dsp_ref_dot_prod_f32(pSrc, pSrc, blockSize, &sum);
+    *pResult = sqrtf(sum / blockSize);
+}
+
+static void
+pk_dsp_ref_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        pDst[i] = fabsf(pSrc[i]);
+    }
+}
+
+static void
+pk_dsp_ref_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] * scale;
+    }
+}
+
+static void
+pk_dsp_ref_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize)
+{
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] + offset;
+    }
+}
+
+static void
+pk_dsp_ref_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        pDst[i] = pSrcA[i] - pSrcB[i];
+    }
+}
+
+void
+pk_dsp_ref_biquad_df1_f32(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    // Coefs per stage {b0, b1, b2, a1, a2} (a already negated), state {x1, x2, y1, y2}
+    const float32_t *pIn = pSrc;
+    for (size_t s = 0; s < ctx->numStages; s++)
+    {
+        const float32_t *c = &ctx->pCoeffs[5 * s];
+        float32_t *z = &ctx->pState[4 * s];
+        float32_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float32_t x1 = z[0], x2 = z[1], y1 = z[2], y2 = z[3];
+        float32_t x, y;
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            x = pIn[i];
+            y = b0 * x + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            pDst[i] = y;
+        }
+        z[0] = x1;
+        z[1] = x2;
+        z[2] = y1;
+        z[3] = y2;
+        pIn = pDst;
+    }
+}
+
+void
+pk_dsp_ref_biquad_df1_multi_range_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize, uint32_t chStart, uint32_t chEnd)
+{
+    // Stage by stage over block; inner loop runs across channels [chStart, chEnd)
+    uint32_t nc = ctx->numChannels;
+    const float32_t *pIn = pSrc;
+    for (size_t s = 0; s < ctx->numStages; s++)
+    {
+        const float32_t *b0 = &ctx->pCoeffs[5 * nc * s];
+        const float32_t *b1 = &b0[nc], *b2 = &b0[2 * nc], *a1 = &b0[3 * nc], *a2 = &b0[4 * nc];
+        float32_t *x1 = &ctx->pState[4 * nc * s];
+        float32_t *x2 = &x1[nc], *y1 = &x1[2 * nc], *y2 = &x1[3 * nc];
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            const float32_t *x = &pIn[i * nc];
+            float32_t *out = &pDst[i * nc];
+            for (size_t c = chStart; c < chEnd; c++)
+            {
+                float32_t xc = x[c];
+                float32_t y = b0[c] * xc + b1[c] * x1[c] + b2[c] * x2[c] + a1[c] * y1[c] + a2[c] * y2[c];
+                x2[c] = x1[c];
+                x1[c] = xc;
+                y2[c] = y1[c];
+                y1[c] = y;
+                out[c] = y;
+            }
+        }
+        pIn = pDst;
+    }
+}
+
+void
+pk_dsp_ref_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_ref_biquad_df1_multi_range_f32(ctx, pSrc, pDst, blockSize, 0, ctx->numChannels);
+}
+
+static const pk_dsp_backend_t pkDspBackendRef = {
+    .name = "ref",
+    .dot_prod = pk_dsp_ref_dot_prod_f32,
+    .max = pk_dsp_ref_max_f32,
+    .mean = pk_dsp_ref_mean_f32,
+    .var = pk_dsp_ref_var_f32,
+    .rms = pk_dsp_ref_rms_f32,
+    .abs = pk_dsp_ref_abs_f32,
+    .scale = pk_dsp_ref_scale_f32,
+    .offset = pk_dsp_ref_offset_f32,
+    .sub = pk_dsp_ref_sub_f32,
+    .biquad_df1 = pk_dsp_ref_biquad_df1_f32,
+    .biquad_df1_multi = pk_dsp_ref_biquad_df1_multi_f32,
+};
+
+/******************************************************************************
+ * Dispatch
+ ******************************************************************************/
+
+// Resolved on first use from PK_DSP_BACKEND unless pk_dsp_init is called. Atomic so
+// threads racing on first use each publish the same complete backend.
+static pk_dsp_backend_ptr_t pkDsp = NULL;
+
+static uint32_t
+pk_dsp_cpu_has_avx2(void)
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return 0;
+#endif
+}
+
+static const pk_dsp_backend_t *
+pk_dsp_resolve_backend(uint32_t backend)
+{
+    switch (backend)
+    {
+    case PK_DSP_BACKEND_AUTO:
+#if defined(__x86_64__)
+        return pk_dsp_cpu_has_avx2() ? &pkDspBackendAvx2 : &pkDspBackendRef;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+        return &pkDspBackendNeon;
+#else
+        return &pkDspBackendCmsis;
+#endif
+    case PK_DSP_BACKEND_CMSIS:
+        return &pkDspBackendCmsis;
+    case PK_DSP_BACKEND_REF:
+        return &pkDspBackendRef;
+    case PK_DSP_BACKEND_AVX2:
+#if defined(__x86_64__)
+        return pk_dsp_cpu_has_avx2() ? &pkDspBackendAvx2 : NULL;
+#else
+        return NULL;
+#endif
+    case PK_DSP_BACKEND_NEON:
+#if defined(__aarch64__) && defined(__ARM_NEON)
+        return &pkDspBackendNeon;
+#else
+        return NULL;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+uint32_t
+pk_dsp_init(uint32_t backend)
+{
+    const pk_dsp_backend_t *b = pk_dsp_resolve_backend(backend);
+    if (b == NULL)
+    {
+        return 1;
+    }
+    PK_DSP_STORE(&pkDsp, b);
+    return 0;
+}
+
+const pk_dsp_backend_t *
+pk_dsp_get_backend(void)
+{
+    const pk_dsp_backend_t *b = PK_DSP_LOAD(&pkDsp);
+    if (b == NULL)
+    {
+        b = pk_dsp_resolve_backend(PK_DSP_BACKEND);
+        b = b != NULL ? b : &pkDspBackendRef;
+        // Keep a backend installed concurrently by pk_dsp_init
+        const pk_dsp_backend_t *expected = NULL;
+        if (!PK_DSP_CAS(&pkDsp, &expected, b))
+        {
+            b = expected;
+        }
+    }
+    return b;
+}
+
+void
+pk_dsp_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult)
+{
+    pk_dsp_get_backend()->dot_prod(pSrcA, pSrcB, blockSize, pResult);
+}
+
+void
+pk_dsp_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    pk_dsp_get_backend()->max(pSrc, blockSize, pResult, pIndex);
+}
+
+void
+pk_dsp_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    pk_dsp_get_backend()->mean(pSrc, blockSize, pResult);
+}
+
+void
+pk_dsp_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    pk_dsp_get_backend()->var(pSrc, blockSize, pResult);
+}
+
+void
+pk_dsp_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    pk_dsp_get_backend()->rms(pSrc, blockSize, pResult);
+}
+
+void
+pk_dsp_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->abs(pSrc, pDst, blockSize);
+}
+
+void
+pk_dsp_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->scale(pSrc, scale, pDst, blockSize);
+}
+
+void
+pk_dsp_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->offset(pSrc, offset, pDst, blockSize);
+}
+
+void
+pk_dsp_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->sub(pSrcA, pSrcB, pDst, blockSize);
+}
+
+void
+pk_dsp_biquad_df1_f32(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->biquad_df1(ctx, pSrc, pDst, blockSize);
+}
+
+void
+pk_dsp_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    pk_dsp_get_backend()->biquad_df1_multi(ctx, pSrc, pDst, blockSize);
+}
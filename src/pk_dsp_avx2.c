@@ -0,0 +1,277 @@
+/**
+ * @file pk_dsp_avx2.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: DSP backend (x86-64 AVX2/FMA)
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+#include <math.h>
+#include <immintrin.h>
+#include "arm_math.h"
+
+#include "pk_dsp.h"
+#include "pk_dsp_internal.h"
+
+#define PK_AVX2 __attribute__((target("avx2,fma")))
+
+static inline PK_AVX2 float32_t
+pk_dsp_avx2_hsum(__m256 v)
+{
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= blockSize; i += 16)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&pSrcA[i]), _mm256_loadu_ps(&pSrcB[i]), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&pSrcA[i + 8]), _mm256_loadu_ps(&pSrcB[i + 8]), acc1);
+    }
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&pSrcA[i]), _mm256_loadu_ps(&pSrcB[i]), acc0);
+    }
+    float32_t sum = pk_dsp_avx2_hsum(_mm256_add_ps(acc0, acc1));
+    for (; i < blockSize; i++)
+    {
+        sum += pSrcA[i] * pSrcB[i];
+    }
+    *pResult = sum;
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    // Find max value vectorized then locate its first occurrence
+    float32_t maxVal = pSrc[0];
+    size_t i = 0;
+    if (blockSize >= 8)
+    {
+        __m256 vmax = _mm256_loadu_ps(pSrc);
+        for (i = 8; i + 8 <= blockSize; i += 8)
+        {
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(&pSrc[i]));
+        }
+        __m128 m = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        maxVal = _mm_cvtss_f32(m);
+    }
+    for (; i < blockSize; i++)
+    {
+        maxVal = pSrc[i] > maxVal ? pSrc[i] : maxVal;
+    }
+    __m256 vref = _mm256_set1_ps(maxVal);
+    for (i = 0; i + 8 <= blockSize; i += 8)
+    {
+        int bits = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(&pSrc[i]), vref, _CMP_EQ_OQ));
+        if (bits)
+        {
+            *pResult = maxVal;
+            *pIndex = i + __builtin_ctz(bits);
+            return;
+        }
+    }
+    for (; i < blockSize && pSrc[i] != maxVal; i++)
+    {
+    }
+    *pResult = maxVal;
+    *pIndex = i < blockSize ? i : 0;
+}
+
+static PK_AVX2 float32_t
+pk_dsp_avx2_sum_f32(const float32_t *pSrc, uint32_t blockSize)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= blockSize; i += 16)
+    {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(&pSrc[i]));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(&pSrc[i + 8]));
+    }
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(&pSrc[i]));
+    }
+    float32_t sum = pk_dsp_avx2_hsum(_mm256_add_ps(acc0, acc1));
+    for (; i < blockSize; i++)
+    {
+        sum += pSrc[i];
+    }
+    return sum;
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    *pResult = pk_dsp_avx2_sum_f32(pSrc, blockSize) / blockSize;
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    if (blockSize <= 1)
+    {
+        *pResult = 0;
+        return;
+    }
+    float32_t mu = pk_dsp_avx2_sum_f32(pSrc, blockSize) / blockSize;
+    __m256 vmu = _mm256_set1_ps(mu);
+    __m256 acc = _mm256_setzero_ps();
+    __m256 d;
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        d = _mm256_sub_ps(_mm256_loadu_ps(&pSrc[i]), vmu);
+        acc = _mm256_fmadd_ps(d, d, acc);
+    }
+    float32_t sum = pk_dsp_avx2_hsum(acc);
+    for (; i < blockSize; i++)
+    {
+        sum += (pSrc[i] - mu) * (pSrc[i] - mu);
+    }
+    *pResult = sum / (blockSize - 1);
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum;
+    pk_dsp_avx2_dot_prod_f32(pSrc, pSrc, blockSize, &sum);
+    *pResult = sqrtf(sum / blockSize);
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        _mm256_storeu_ps(&pDst[i], _mm256_and_ps(_mm256_loadu_ps(&pSrc[i]), mask));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = fabsf(pSrc[i]);
+    }
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    __m256 k = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        _mm256_storeu_ps(&pDst[i], _mm256_mul_ps(_mm256_loadu_ps(&pSrc[i]), k));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] * scale;
+    }
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize)
+{
+    __m256 k = _mm256_set1_ps(offset);
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        _mm256_storeu_ps(&pDst[i], _mm256_add_ps(_mm256_loadu_ps(&pSrc[i]), k));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] + offset;
+    }
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        _mm256_storeu_ps(&pDst[i], _mm256_sub_ps(_mm256_loadu_ps(&pSrcA[i]), _mm256_loadu_ps(&pSrcB[i])));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrcA[i] - pSrcB[i];
+    }
+}
+
+static PK_AVX2 void
+pk_dsp_avx2_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    // 8 channels per lane group with state held in registers across the block
+    uint32_t nc = ctx->numChannels;
+    uint32_t nv = nc & ~7U;
+    for (size_t c = 0; c < nv; c += 8)
+    {
+        const float32_t *pIn = pSrc;
+        for (size_t s = 0; s < ctx->numStages; s++)
+        {
+            const float32_t *k = &ctx->pCoeffs[5 * nc * s + c];
+            float32_t *z = &ctx->pState[4 * nc * s + c];
+            __m256 b0 = _mm256_loadu_ps(k), b1 = _mm256_loadu_ps(&k[nc]), b2 = _mm256_loadu_ps(&k[2 * nc]);
+            __m256 a1 = _mm256_loadu_ps(&k[3 * nc]), a2 = _mm256_loadu_ps(&k[4 * nc]);
+            __m256 x1 = _mm256_loadu_ps(z), x2 = _mm256_loadu_ps(&z[nc]);
+            __m256 y1 = _mm256_loadu_ps(&z[2 * nc]), y2 = _mm256_loadu_ps(&z[3 * nc]);
+            __m256 x, y;
+            for (size_t i = 0; i < blockSize; i++)
+            {
+                x = _mm256_loadu_ps(&pIn[i * nc + c]);
+                y = _mm256_mul_ps(b0, x);
+                y = _mm256_fmadd_ps(b1, x1, y);
+                y = _mm256_fmadd_ps(b2, x2, y);
+                y = _mm256_fmadd_ps(a1, y1, y);
+                y = _mm256_fmadd_ps(a2, y2, y);
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                _mm256_storeu_ps(&pDst[i * nc + c], y);
+            }
+            _mm256_storeu_ps(z, x1);
+            _mm256_storeu_ps(&z[nc], x2);
+            _mm256_storeu_ps(&z[2 * nc], y1);
+            _mm256_storeu_ps(&z[3 * nc], y2);
+            pIn = pDst;
+        }
+    }
+    if (nv < nc)
+    {
+        pk_dsp_ref_biquad_df1_multi_range_f32(ctx, pSrc, pDst, blockSize, nv, nc);
+    }
+}
+
+// Single-channel biquad recursion is serial; reuse the scalar reference
+const pk_dsp_backend_t pkDspBackendAvx2 = {
+    .name = "avx2",
+    .dot_prod = pk_dsp_avx2_dot_prod_f32,
+    .max = pk_dsp_avx2_max_f32,
+    .mean = pk_dsp_avx2_mean_f32,
+    .var = pk_dsp_avx2_var_f32,
+    .rms = pk_dsp_avx2_rms_f32,
+    .abs = pk_dsp_avx2_abs_f32,
+    .scale = pk_dsp_avx2_scale_f32,
+    .offset = pk_dsp_avx2_offset_f32,
+    .sub = pk_dsp_avx2_sub_f32,
+    .biquad_df1 = pk_dsp_ref_biquad_df1_f32,
+    .biquad_df1_multi = pk_dsp_avx2_biquad_df1_multi_f32,
+};
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file pk_dsp_internal.h
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: DSP backend internals shared by backend sources
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef __PK_DSP_INTERNAL_H
+#define __PK_DSP_INTERNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "arm_math.h"
+#include "pk_dsp.h"
+
+#if defined(__x86_64__)
+extern const pk_dsp_backend_t pkDspBackendAvx2;
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+extern const pk_dsp_backend_t pkDspBackendNeon;
+#endif
+
+/**
+ * @brief Scalar reference biquad cascade (direct form I), used by backends
+ * without a vectorized single-channel recursion
+ *
+ * @param ctx Filter instance
+ * @param pSrc Source signal
+ * @param pDst Result signal
+ * @param blockSize Length of signal
+ */
+void
+pk_dsp_ref_biquad_df1_f32(const arm_biquad_casd_df1_inst_f32 *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+/**
+ * @brief Scalar reference multi-channel biquad cascade over channels
+ * [chStart, chEnd), used for channels left over after vector lanes
+ *
+ * @param ctx Filter instance
+ * @param pSrc Source signal (blockSize*numChannels interleaved)
+ * @param pDst Result signal (may alias pSrc)
+ * @param blockSize Samples per channel
+ * @param chStart First channel
+ * @param chEnd One past last channel
+ */
+void
+pk_dsp_ref_biquad_df1_multi_range_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize, uint32_t chStart, uint32_t chEnd);
+
+/**
+ * @brief Scalar reference multi-channel biquad cascade over all channels
+ *
+ * @param ctx Filter instance
+ * @param pSrc Source signal (blockSize*numChannels interleaved)
+ * @param pDst Result signal (may alias pSrc)
+ * @param blockSize Samples per channel
+ */
+void
+pk_dsp_ref_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PK_DSP_INTERNAL_H
@@ -0,0 +1,242 @@
+/**
+ * @file pk_dsp_neon.c
+ * @author Adam Page (adam.page@ambiq.com)
+ * @brief PhysioKit: DSP backend (AArch64 NEON)
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#if defined(__aarch64__) && defined(__ARM_NEON)
+
+#include <math.h>
+#include <arm_neon.h>
+#include "arm_math.h"
+
+#include "pk_dsp.h"
+#include "pk_dsp_internal.h"
+
+static void
+pk_dsp_neon_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *pResult)
+{
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(&pSrcA[i]), vld1q_f32(&pSrcB[i]));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(&pSrcA[i + 4]), vld1q_f32(&pSrcB[i + 4]));
+    }
+    float32_t sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < blockSize; i++)
+    {
+        sum += pSrcA[i] * pSrcB[i];
+    }
+    *pResult = sum;
+}
+
+static void
+pk_dsp_neon_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    // Find max value vectorized then locate its first occurrence
+    float32_t maxVal = pSrc[0];
+    size_t i = 0;
+    if (blockSize >= 4)
+    {
+        float32x4_t vmax = vld1q_f32(pSrc);
+        for (i = 4; i + 4 <= blockSize; i += 4)
+        {
+            vmax = vmaxq_f32(vmax, vld1q_f32(&pSrc[i]));
+        }
+        maxVal = vmaxvq_f32(vmax);
+    }
+    for (; i < blockSize; i++)
+    {
+        maxVal = pSrc[i] > maxVal ? pSrc[i] : maxVal;
+    }
+    for (i = 0; i < blockSize && pSrc[i] != maxVal; i++)
+    {
+    }
+    *pResult = maxVal;
+    *pIndex = i < blockSize ? i : 0;
+}
+
+static float32_t
+pk_dsp_neon_sum_f32(const float32_t *pSrc, uint32_t blockSize)
+{
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8)
+    {
+        acc0 = vaddq_f32(acc0, vld1q_f32(&pSrc[i]));
+        acc1 = vaddq_f32(acc1, vld1q_f32(&pSrc[i + 4]));
+    }
+    float32_t sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < blockSize; i++)
+    {
+        sum += pSrc[i];
+    }
+    return sum;
+}
+
+static void
+pk_dsp_neon_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    *pResult = pk_dsp_neon_sum_f32(pSrc, blockSize) / blockSize;
+}
+
+static void
+pk_dsp_neon_var_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    if (blockSize <= 1)
+    {
+        *pResult = 0;
+        return;
+    }
+    float32_t mu = pk_dsp_neon_sum_f32(pSrc, blockSize) / blockSize;
+    float32x4_t vmu = vdupq_n_f32(mu);
+    float32x4_t acc = vdupq_n_f32(0);
+    float32x4_t d;
+    size_t i = 0;
+    for (; i + 4 <= blockSize; i += 4)
+    {
+        d = vsubq_f32(vld1q_f32(&pSrc[i]), vmu);
+        acc = vfmaq_f32(acc, d, d);
+    }
+    float32_t sum = vaddvq_f32(acc);
+    for (; i < blockSize; i++)
+    {
+        sum += (pSrc[i] - mu) * (pSrc[i] - mu);
+    }
+    *pResult = sum / (blockSize - 1);
+}
+
+static void
+pk_dsp_neon_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum;
+    pk_dsp_neon_dot_prod_f32(pSrc, pSrc, blockSize, &sum);
+    *pResult = sqrtf(sum / blockSize);
+}
+
+static void
+pk_dsp_neon_abs_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    size_t i = 0;
+    for (; i + 4 <= blockSize; i += 4)
+    {
+        vst1q_f32(&pDst[i], vabsq_f32(vld1q_f32(&pSrc[i])));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = fabsf(pSrc[i]);
+    }
+}
+
+static void
+pk_dsp_neon_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    size_t i = 0;
+    for (; i + 4 <= blockSize; i += 4)
+    {
+        vst1q_f32(&pDst[i], vmulq_n_f32(vld1q_f32(&pSrc[i]), scale));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] * scale;
+    }
+}
+
+static void
+pk_dsp_neon_offset_f32(const float32_t *pSrc, float32_t offset, float32_t *pDst, uint32_t blockSize)
+{
+    float32x4_t k = vdupq_n_f32(offset);
+    size_t i = 0;
+    for (; i + 4 <= blockSize; i += 4)
+    {
+        vst1q_f32(&pDst[i], vaddq_f32(vld1q_f32(&pSrc[i]), k));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrc[i] + offset;
+    }
+}
+
+static void
+pk_dsp_neon_sub_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    size_t i = 0;
+    for (; i + 4 <= blockSize; i += 4)
+    {
+        vst1q_f32(&pDst[i], vsubq_f32(vld1q_f32(&pSrcA[i]), vld1q_f32(&pSrcB[i])));
+    }
+    for (; i < blockSize; i++)
+    {
+        pDst[i] = pSrcA[i] - pSrcB[i];
+    }
+}
+
+static void
+pk_dsp_neon_biquad_df1_multi_f32(const biquad_multi_f32_t *ctx, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    // 4 channels per lane group with state held in registers across the block
+    uint32_t nc = ctx->numChannels;
+    uint32_t nv = nc & ~3U;
+    for (size_t c = 0; c < nv; c += 4)
+    {
+        const float32_t *pIn = pSrc;
+        for (size_t s = 0; s < ctx->numStages; s++)
+        {
+            const float32_t *k = &ctx->pCoeffs[5 * nc * s + c];
+            float32_t *z = &ctx->pState[4 * nc * s + c];
+            float32x4_t b0 = vld1q_f32(k), b1 = vld1q_f32(&k[nc]), b2 = vld1q_f32(&k[2 * nc]);
+            float32x4_t a1 = vld1q_f32(&k[3 * nc]), a2 = vld1q_f32(&k[4 * nc]);
+            float32x4_t x1 = vld1q_f32(z), x2 = vld1q_f32(&z[nc]);
+            float32x4_t y1 = vld1q_f32(&z[2 * nc]), y2 = vld1q_f32(&z[3 * nc]);
+            float32x4_t x, y;
+            for (size_t i = 0; i < blockSize; i++)
+            {
+                x = vld1q_f32(&pIn[i * nc + c]);
+                y = vmulq_f32(b0, x);
+                y = vfmaq_f32(y, b1, x1);
+                y = vfmaq_f32(y, b2, x2);
+                y = vfmaq_f32(y, a1, y1);
+                y = vfmaq_f32(y, a2, y2);
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                vst1q_f32(&pDst[i * nc + c], y);
+            }
+            vst1q_f32(z, x1);
+            vst1q_f32(&z[nc], x2);
+            vst1q_f32(&z[2 * nc], y1);
+            vst1q_f32(&z[3 * nc], y2);
+            pIn = pDst;
+        }
+    }
+    if (nv < nc)
+    {
+        pk_dsp_ref_biquad_df1_multi_range_f32(ctx, pSrc, pDst, blockSize, nv, nc);
+    }
+}
+
+// Single-channel biquad recursion is serial; reuse the scalar reference
+const pk_dsp_backend_t pkDspBackendNeon = {
+    .name = "neon",
+    .dot_prod = pk_dsp_neon_dot_prod_f32,
+    .max = pk_dsp_neon_max_f32,
+    .mean = pk_dsp_neon_mean_f32,
+    .var = pk_dsp_neon_var_f32,
+    .rms = pk_dsp_neon_rms_f32,
+    .abs = pk_dsp_neon_abs_f32,
+    .scale = pk_dsp_neon_scale_f32,
+    .offset = pk_dsp_neon_offset_f32,
+    .sub = pk_dsp_neon_sub_f32,
+    .biquad_df1 = pk_dsp_ref_biquad_df1_f32,
+    .biquad_df1_multi = pk_dsp_neon_biquad_df1_multi_f32,
+};
+
+#endif
@@ -9,10 +9,13 @@
  *
  */
 #include <math.h>
+#include <string.h>
 #include "arm_math.h"
 
+#include "pk_dsp.h"
 #include "pk_math.h"
 #include "pk_filter.h"
+#include "pk_interpolation.h"
 #include "pk_ecg.h"
 
 uint32_t
@@ -27,6 +30,29 @@ pk_ecg_square_filter_mask(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mas
     return 0;
 }
 
+static inline float32_t
+pk_ecg_abs_gradient_f32(float32_t *ecg, uint32_t ecgLen, uint32_t i)
+{
+    // Matches pk_gradient_f32 incl. forward/backward difference at edges
+    if (i == 0)
+    {
+        return fabsf((-3 * ecg[0] + 4 * ecg[1] - ecg[2]) * 0.5f);
+    }
+    if (i == ecgLen - 1)
+    {
+        return fabsf((3 * ecg[i] - 4 * ecg[i - 1] + ecg[i - 2]) * 0.5f);
+    }
+    return fabsf((ecg[i + 1] - ecg[i - 1]) * 0.5f);
+}
+
+uint32_t
+pk_ecg_peak_state_size_f32(ecg_peak_f32_t *ctx)
+{
+    // Ring of QRS gradient (avgGradLen + 1)
+    uint32_t avgGradLen = (uint32_t)(ctx->sampleRate * ctx->avgWin + 1);
+    return avgGradLen + 1;
+}
+
 uint32_t
 pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint32_t *peaks, uint16_t *mask)
 {
@@ -36,24 +62,187 @@ pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint
     uint32_t minQrsDelay = (uint32_t)(ctx->sampleRate * ctx->qrsDelayWin + 1);
     uint32_t minQrsWidth = 0;
 
-    float32_t *absGrad = &ctx->state[0 * ecgLen];
-    float32_t *qrsGrad = &ctx->state[1 * ecgLen];
-    float32_t *avgGrad = &ctx->state[2 * ecgLen];
-    float32_t *wBuffer = &ctx->state[3 * ecgLen];
+    if (mask != NULL)
+    {
+        for (size_t i = 0; i < ecgLen; i++)
+        {
+            mask[i] = 0;
+        }
+    }
+    if (ecgLen < 3 || ecgLen <= qrsGradLen || ecgLen <= avgGradLen)
+    {
+        return 0;
+    }
+
+    // Gradient, abs, both smoothers and threshold are fused into a single sweep.
+    // Smoothers follow pk_smooth_signal_f32 exactly (centered window, running
+    // sum w/ per-window resync, edge replication) so results are identical.
+    // Only the QRS gradient needs buffering: ring of avgGradLen + 1.
+    float32_t *qrsBuf = ctx->state;
+    uint32_t qrsBufLen = avgGradLen + 1;
+
+    uint32_t qrsHalf = qrsGradLen / 2;
+    uint32_t qrsEnd = ecgLen - qrsGradLen - 1 + qrsHalf;
+    float32_t qrsScale = 1.0f / qrsGradLen;
+    float32_t qrsSum = 0;
+    uint32_t qrsIter = 0;
+    uint32_t qrsNext = 0;
+
+    uint32_t avgHalf = avgGradLen / 2;
+    uint32_t avgEnd = ecgLen - avgGradLen - 1 + avgHalf;
+    float32_t avgScale = 1.0f / avgGradLen;
+    float32_t avgSum = 0;
+    uint32_t avgIter = 0;
+
+    uint32_t k, c, need;
+
+    for (size_t i = 0; i < qrsGradLen; i++)
+    {
+        qrsSum += pk_ecg_abs_gradient_f32(ecg, ecgLen, i);
+    }
+
+    uint32_t riseEdge, fallEdge, peakDelay, peakLen, peak;
+    float32_t peakVal, qrsGrad, avgGrad, diff;
+    float32_t prevDiff = 0;
+    uint32_t numPeaks = 0;
+    int32_t m = -1, n = -1;
+    for (size_t i = 0; i < ecgLen; i++)
+    {
+        // Advance average smoother to window centered on i
+        c = i < avgHalf ? avgHalf : (i > avgEnd ? avgEnd : i);
+        while (avgIter + avgHalf < c)
+        {
+            if ((avgIter + 1) % avgGradLen == 0)
+            {
+                avgSum = 0;
+                for (k = avgIter + 1; k <= avgIter + avgGradLen; k++)
+                {
+                    avgSum += qrsBuf[k % qrsBufLen];
+                }
+            }
+            else
+            {
+                avgSum += qrsBuf[(avgIter + avgGradLen) % qrsBufLen] - qrsBuf[avgIter % qrsBufLen];
+            }
+            avgIter++;
+        }
+
+        // Produce QRS gradient samples needed by next average update
+        need = avgIter + avgGradLen < ecgLen - 1 ? avgIter + avgGradLen : ecgLen - 1;
+        for (; qrsNext <= need; qrsNext++)
+        {
+            c = qrsNext < qrsHalf ? qrsHalf : (qrsNext > qrsEnd ? qrsEnd : qrsNext);
+            while (qrsIter + qrsHalf < c)
+            {
+                if ((qrsIter + 1) % qrsGradLen == 0)
+                {
+                    qrsSum = 0;
+                    for (k = qrsIter + 1; k <= qrsIter + qrsGradLen; k++)
+                    {
+                        qrsSum += pk_ecg_abs_gradient_f32(ecg, ecgLen, k);
+                    }
+                }
+                else
+                {
+                    qrsSum += pk_ecg_abs_gradient_f32(ecg, ecgLen, qrsIter + qrsGradLen) - pk_ecg_abs_gradient_f32(ecg, ecgLen, qrsIter);
+                }
+                qrsIter++;
+            }
+            qrsBuf[qrsNext % qrsBufLen] = qrsSum * qrsScale;
+            if (qrsNext == avgGradLen - 1)
+            {
+                // Initial average window is now available
+                for (k = 0; k < avgGradLen; k++)
+                {
+                    avgSum += qrsBuf[k];
+                }
+            }
+        }
+
+        // Subtract scaled average gradient as threshold
+        qrsGrad = qrsBuf[i % qrsBufLen];
+        avgGrad = avgSum * avgScale;
+        avgGrad = avgGrad * ctx->qrsPromWeight;
+        diff = qrsGrad - avgGrad;
 
-    // Compute absolute gradient
-    pk_gradient_f32(ecg, absGrad, ecgLen);
-    arm_abs_f32(absGrad, absGrad, ecgLen);
+        if (i == 0)
+        {
+            prevDiff = diff;
+            continue;
+        }
+        riseEdge = prevDiff <= 0 && diff > 0;
+        fallEdge = prevDiff > 0 && diff <= 0;
+        prevDiff = diff;
+        if (riseEdge)
+        {
+            m = i;
+        }
+        else if (fallEdge && m != -1)
+        {
+            n = i;
+        }
+        // If detected
+        if (m != -1 && n != -1)
+        {
+            peakLen = n - m + 1;
+            pk_dsp_max_f32(&ecg[m], peakLen, &peakVal, &peak);
+            peak += m;
+            peakDelay = numPeaks > 0 ? peak - peaks[numPeaks - 1] : minQrsDelay;
+            if (peakLen >= minQrsWidth && peakDelay >= minQrsDelay)
+            {
+                peaks[numPeaks++] = peak;
+                // Mark QRS complex region
+                if (mask != NULL)
+                {
+                    for (size_t j = m; j < n; j++)
+                    {
+                        mask[j] = 1;
+                    }
+                }
+            }
+            m = -1;
+            n = -1;
+        }
+    }
+    return numPeaks;
+}
+
+uint32_t
+pk_ecg_peak_state_size_q15(ecg_peak_q15_t *ctx)
+{
+    // Ring of QRS gradient window sums (avgGradLen + 1)
+    uint32_t avgGradLen = (uint32_t)(ctx->sampleRate * ctx->avgWin + 1);
+    return avgGradLen + 1;
+}
 
-    // Smooth gradients
-    pk_smooth_signal_f32(absGrad, qrsGrad, ecgLen, wBuffer, qrsGradLen);
-    pk_smooth_signal_f32(qrsGrad, avgGrad, ecgLen, wBuffer, avgGradLen);
+static inline q31_t
+pk_ecg_abs_gradient_q15(q15_t *ecg, uint32_t ecgLen, uint32_t i)
+{
+    // 2x pk_ecg_abs_gradient_f32 so no precision is lost to the halving
+    q31_t d;
+    if (i == 0)
+    {
+        d = -3 * (q31_t)ecg[0] + 4 * (q31_t)ecg[1] - ecg[2];
+    }
+    else if (i == ecgLen - 1)
+    {
+        d = 3 * (q31_t)ecg[i] - 4 * (q31_t)ecg[i - 1] + ecg[i - 2];
+    }
+    else
+    {
+        d = (q31_t)ecg[i + 1] - ecg[i - 1];
+    }
+    return d < 0 ? -d : d;
+}
 
-    // Min QRS height
-    arm_scale_f32(avgGrad, ctx->qrsPromWeight, avgGrad, ecgLen);
+uint32_t
+pk_ecg_find_peaks_q15(ecg_peak_q15_t *ctx, q15_t *ecg, uint32_t ecgLen, uint32_t *peaks, uint16_t *mask)
+{
+    uint32_t qrsGradLen = (uint32_t)(ctx->sampleRate * ctx->qrsWin + 1);
+    uint32_t avgGradLen = (uint32_t)(ctx->sampleRate * ctx->avgWin + 1);
 
-    // Subtract average gradient as threshold
-    arm_sub_f32(qrsGrad, avgGrad, qrsGrad, ecgLen);
+    uint32_t minQrsDelay = (uint32_t)(ctx->sampleRate * ctx->qrsDelayWin + 1);
+    uint32_t minQrsWidth = 0;
 
     if (mask != NULL)
     {
@@ -62,15 +251,86 @@ pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint
             mask[i] = 0;
         }
     }
+    if (ecgLen < 3 || ecgLen <= qrsGradLen || ecgLen <= avgGradLen)
+    {
+        return 0;
+    }
+
+    // Mirrors pk_ecg_find_peaks_f32 but keeps QRS gradient window sums (not
+    // means) in the ring. Sums are exact (|grad| <= 2^18) so no resync is
+    // needed, and diff > 0 <=> qrsSum * avgGradLen > weight * avgSum.
+    q31_t *qrsBuf = ctx->state;
+    uint32_t qrsBufLen = avgGradLen + 1;
+
+    uint32_t qrsHalf = qrsGradLen / 2;
+    uint32_t qrsEnd = ecgLen - qrsGradLen - 1 + qrsHalf;
+    q31_t qrsSum = 0;
+    uint32_t qrsIter = 0;
+    uint32_t qrsNext = 0;
+
+    uint32_t avgHalf = avgGradLen / 2;
+    uint32_t avgEnd = ecgLen - avgGradLen - 1 + avgHalf;
+    q63_t avgSum = 0;
+    uint32_t avgIter = 0;
+
+    // Prominence weight in Q12
+    q63_t promWeight = (q63_t)(ctx->qrsPromWeight * 4096.0f + 0.5f);
+
+    uint32_t k, c, need;
+
+    for (size_t i = 0; i < qrsGradLen; i++)
+    {
+        qrsSum += pk_ecg_abs_gradient_q15(ecg, ecgLen, i);
+    }
 
     uint32_t riseEdge, fallEdge, peakDelay, peakLen, peak;
-    float32_t peakVal;
+    q15_t peakVal;
+    q63_t diff;
+    q63_t prevDiff = 0;
     uint32_t numPeaks = 0;
     int32_t m = -1, n = -1;
-    for (size_t i = 1; i < ecgLen; i++)
+    for (size_t i = 0; i < ecgLen; i++)
     {
-        riseEdge = qrsGrad[i - 1] <= 0 && qrsGrad[i] > 0;
-        fallEdge = qrsGrad[i - 1] > 0 && qrsGrad[i] <= 0;
+        // Advance average smoother to window centered on i
+        c = i < avgHalf ? avgHalf : (i > avgEnd ? avgEnd : i);
+        while (avgIter + avgHalf < c)
+        {
+            avgSum += qrsBuf[(avgIter + avgGradLen) % qrsBufLen] - qrsBuf[avgIter % qrsBufLen];
+            avgIter++;
+        }
+
+        // Produce QRS gradient sums needed by next average update
+        need = avgIter + avgGradLen < ecgLen - 1 ? avgIter + avgGradLen : ecgLen - 1;
+        for (; qrsNext <= need; qrsNext++)
+        {
+            c = qrsNext < qrsHalf ? qrsHalf : (qrsNext > qrsEnd ? qrsEnd : qrsNext);
+            while (qrsIter + qrsHalf < c)
+            {
+                qrsSum += pk_ecg_abs_gradient_q15(ecg, ecgLen, qrsIter + qrsGradLen) - pk_ecg_abs_gradient_q15(ecg, ecgLen, qrsIter);
+                qrsIter++;
+            }
+            qrsBuf[qrsNext % qrsBufLen] = qrsSum;
+            if (qrsNext == avgGradLen - 1)
+            {
+                // Initial average window is now available
+                for (k = 0; k < avgGradLen; k++)
+                {
+                    avgSum += qrsBuf[k];
+                }
+            }
+        }
+
+        // Subtract scaled average gradient as threshold
+        diff = ((q63_t)qrsBuf[i % qrsBufLen] * avgGradLen << 12) - promWeight * avgSum;
+
+        if (i == 0)
+        {
+            prevDiff = diff;
+            continue;
+        }
+        riseEdge = prevDiff <= 0 && diff > 0;
+        fallEdge = prevDiff > 0 && diff <= 0;
+        prevDiff = diff;
         if (riseEdge)
         {
             m = i;
@@ -83,7 +343,7 @@ pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint
         if (m != -1 && n != -1)
         {
             peakLen = n - m + 1;
-            arm_max_f32(&ecg[m], peakLen, &peakVal, &peak);
+            arm_max_q15(&ecg[m], peakLen, &peakVal, &peak);
             peak += m;
             peakDelay = numPeaks > 0 ? peak - peaks[numPeaks - 1] : minQrsDelay;
             if (peakLen >= minQrsWidth && peakDelay >= minQrsDelay)
@@ -105,6 +365,127 @@ pk_ecg_find_peaks_f32(ecg_peak_f32_t *ctx, float32_t *ecg, uint32_t ecgLen, uint
     return numPeaks;
 }
 
+uint32_t
+pk_ecg_peak_stream_state_size_f32(ecg_peak_stream_f32_t *ctx)
+{
+    uint32_t qrsGradLen = (uint32_t)(ctx->sampleRate * ctx->qrsWin + 1);
+    uint32_t avgGradLen = (uint32_t)(ctx->sampleRate * ctx->avgWin + 1);
+    return 2 * qrsGradLen + avgGradLen + PK_ECG_STREAM_CHUNK + 1;
+}
+
+uint32_t
+pk_ecg_init_peak_stream_f32(ecg_peak_stream_f32_t *ctx)
+{
+    uint32_t qrsGradLen = (uint32_t)(ctx->sampleRate * ctx->qrsWin + 1);
+    uint32_t avgGradLen = (uint32_t)(ctx->sampleRate * ctx->avgWin + 1);
+
+    ctx->qrsAvg.windowSize = qrsGradLen;
+    ctx->qrsAvg.buffer = &ctx->state[0];
+    ctx->avgAvg.windowSize = avgGradLen;
+    ctx->avgAvg.buffer = &ctx->state[qrsGradLen];
+    ctx->ecgBuf = &ctx->state[qrsGradLen + avgGradLen];
+    ctx->ecgBufLen = qrsGradLen + PK_ECG_STREAM_CHUNK + 1;
+    arm_fill_f32(0, ctx->ecgBuf, ctx->ecgBufLen);
+    pk_init_moving_average_f32(&ctx->qrsAvg);
+    pk_init_moving_average_f32(&ctx->avgAvg);
+
+    // Causal smoother output at n is centered at n - qrsDelay
+    ctx->qrsDelay = qrsGradLen - 1 - qrsGradLen / 2;
+    ctx->minQrsDelay = (uint32_t)(ctx->sampleRate * ctx->qrsDelayWin + 1);
+    ctx->x1 = 0;
+    ctx->x2 = 0;
+    ctx->prevDiff = 0;
+    ctx->numSamples = 0;
+    ctx->inQrs = 0;
+    ctx->peakVal = 0;
+    ctx->peakIdx = 0;
+    ctx->hasPeak = 0;
+    ctx->lastPeak = 0;
+    return 0;
+}
+
+uint32_t
+pk_ecg_find_peaks_stream_f32(ecg_peak_stream_f32_t *ctx, float32_t *ecg, uint32_t blockSize, uint32_t *peaks)
+{
+    float32_t qrsGrad[PK_ECG_STREAM_CHUNK];
+    float32_t avgGrad[PK_ECG_STREAM_CHUNK];
+    uint32_t numPeaks = 0;
+    uint32_t numGrad, gradIdx, idx, peakDelay;
+    float32_t x, diff, ecgVal;
+
+    for (size_t offset = 0; offset < blockSize; offset += PK_ECG_STREAM_CHUNK)
+    {
+        uint32_t chunkLen = blockSize - offset < PK_ECG_STREAM_CHUNK ? blockSize - offset : PK_ECG_STREAM_CHUNK;
+
+        // Absolute gradient is available one sample after its center sample
+        numGrad = 0;
+        gradIdx = ctx->numSamples - 1;
+        for (size_t i = 0; i < chunkLen; i++)
+        {
+            x = ecg[offset + i];
+            ctx->ecgBuf[ctx->numSamples % ctx->ecgBufLen] = x;
+            if (ctx->numSamples >= 2)
+            {
+                qrsGrad[numGrad++] = fabsf(x - ctx->x2) / 2.0f;
+            }
+            else if (ctx->numSamples == 1)
+            {
+                gradIdx = 0;
+                qrsGrad[numGrad++] = fabsf(x - ctx->x1);
+            }
+            ctx->x2 = ctx->x1;
+            ctx->x1 = x;
+            ctx->numSamples++;
+        }
+
+        // Smooth gradients
+        pk_apply_moving_average_f32(&ctx->qrsAvg, qrsGrad, qrsGrad, numGrad);
+        pk_apply_moving_average_f32(&ctx->avgAvg, qrsGrad, avgGrad, numGrad);
+
+        for (size_t i = 0; i < numGrad; i++, gradIdx++)
+        {
+            // Wait for average gradient window to fill before thresholding
+            if (gradIdx < ctx->avgAvg.windowSize)
+            {
+                continue;
+            }
+            // Align thresholded gradient with ECG sample
+            idx = gradIdx - ctx->qrsDelay;
+            diff = qrsGrad[i] - ctx->qrsPromWeight * avgGrad[i];
+            ecgVal = ctx->ecgBuf[idx % ctx->ecgBufLen];
+            if (ctx->prevDiff <= 0 && diff > 0)
+            {
+                // Rising edge
+                ctx->inQrs = 1;
+                ctx->peakVal = ecgVal;
+                ctx->peakIdx = idx;
+            }
+            else if (ctx->inQrs)
+            {
+                if (ecgVal > ctx->peakVal)
+                {
+                    ctx->peakVal = ecgVal;
+                    ctx->peakIdx = idx;
+                }
+                // Falling edge
+                if (ctx->prevDiff > 0 && diff <= 0)
+                {
+                    peakDelay = ctx->hasPeak ? ctx->peakIdx - ctx->lastPeak : ctx->minQrsDelay;
+                    if (peakDelay >= ctx->minQrsDelay)
+                    {
+                        peaks[numPeaks++] = ctx->peakIdx;
+                        ctx->lastPeak = ctx->peakIdx;
+                        ctx->hasPeak = 1;
+                    }
+                    ctx->inQrs = 0;
+                }
+            }
+            ctx->prevDiff = diff;
+        }
+    }
+    return numPeaks;
+}
+
 uint32_t
 pk_ecg_compute_rr_intervals(uint32_t *peaks, uint32_t numPeaks, uint32_t *rrIntervals)
 {
@@ -154,12 +535,131 @@ pk_ecg_compute_heart_rate_from_rr_intervals(uint32_t *rrIntervals, uint32_t *mas
 }
 
 uint32_t
-pk_ecg_derive_respiratory_rate(uint32_t *peaks, uint32_t *rrIntervals, uint32_t numPeaks, uint32_t sampleRate, float32_t *respRate)
-{
-    // Will need state to store FFT
-    // Interpolate (peaks, rri)
-    // Filter to respiratory band
-    // Compute FFT and compute power spectrum
-    // Find peak in power spectrum
-    return 1;
+pk_ecg_edr_state_size_f32(ecg_edr_f32_t *ctx)
+{
+    uint32_t gridLen = (uint32_t)(ctx->windowLen * ctx->interpRate);
+    uint32_t fftLen = pk_next_power_of_2(2 * gridLen);
+    return 2 * gridLen + 3 * ctx->maxPeaks + 2 * fftLen;
+}
+
+uint32_t
+pk_ecg_init_edr_f32(ecg_edr_f32_t *ctx)
+{
+    ctx->gridLen = (uint32_t)(ctx->windowLen * ctx->interpRate);
+    // Zero pad 2x for finer spectral peak
+    ctx->fftLen = pk_next_power_of_2(2 * ctx->gridLen);
+    if (ctx->gridLen < 4 || ctx->highFreq >= 0.5f * ctx->interpRate)
+    {
+        return 1;
+    }
+    if (arm_rfft_fast_init_f32(&ctx->fftCtx, ctx->fftLen) != ARM_MATH_SUCCESS)
+    {
+        return 1;
+    }
+    ctx->gridTime = &ctx->state[0];
+    ctx->ampSig = &ctx->state[ctx->gridLen];
+    ctx->beatTime = &ctx->state[2 * ctx->gridLen];
+    ctx->beatRR = &ctx->beatTime[ctx->maxPeaks];
+    ctx->beatAmp = &ctx->beatRR[ctx->maxPeaks];
+    ctx->edrSig = &ctx->beatAmp[ctx->maxPeaks];
+    ctx->spec = &ctx->edrSig[ctx->fftLen];
+    for (size_t i = 0; i < ctx->gridLen; i++)
+    {
+        ctx->gridTime[i] = (float32_t)i / ctx->interpRate;
+    }
+    filter_design_f32_t hp = {.family = PK_FILTER_BUTTERWORTH, .type = PK_FILTER_HIGHPASS, .order = 2, .lowcut = ctx->lowFreq, .sampleRate = ctx->interpRate};
+    filter_design_f32_t lp = {.family = PK_FILTER_BUTTERWORTH, .type = PK_FILTER_LOWPASS, .order = 2, .lowcut = ctx->highFreq, .sampleRate = ctx->interpRate};
+    if (pk_design_biquad_filter_f32(&hp, &ctx->filterCoeffs[0]) || pk_design_biquad_filter_f32(&lp, &ctx->filterCoeffs[5]))
+    {
+        return 1;
+    }
+    ctx->filter.numStages = 2;
+    ctx->filter.pCoeffs = ctx->filterCoeffs;
+    ctx->filter.pState = ctx->filterState;
+    pk_init_biquad_filter_f32(&ctx->filter);
+    return 0;
+}
+
+uint32_t
+pk_ecg_derive_respiratory_rate(ecg_edr_f32_t *ctx, float32_t *ecg, uint32_t *peaks, uint32_t *rrIntervals, uint8_t *mask, uint32_t numPeaks, float32_t *respRate)
+{
+    // Collect valid beats relative to first valid peak
+    uint32_t numValid = 0;
+    uint32_t firstPeak = 0;
+    for (size_t i = 0; i < numPeaks && numValid < ctx->maxPeaks; i++)
+    {
+        if (mask[i] != 0)
+        {
+            continue;
+        }
+        if (numValid == 0)
+        {
+            firstPeak = peaks[i];
+        }
+        ctx->beatTime[numValid] = (float32_t)(peaks[i] - firstPeak) / ctx->sampleRate;
+        ctx->beatRR[numValid] = (float32_t)rrIntervals[i] / ctx->sampleRate;
+        ctx->beatAmp[numValid] = ecg[peaks[i]];
+        numValid++;
+    }
+    if (numValid < 4)
+    {
+        return 1;
+    }
+    uint32_t numGrid = (uint32_t)(ctx->beatTime[numValid - 1] * ctx->interpRate) + 1;
+    numGrid = numGrid > ctx->gridLen ? ctx->gridLen : numGrid;
+    if (numGrid < 4)
+    {
+        return 1;
+    }
+
+    // Interpolate onto grid and combine standardized RR and amplitude modulation
+    pk_inter1d_f32(ctx->beatTime, ctx->beatRR, numValid, ctx->gridTime, ctx->edrSig, numGrid);
+    pk_inter1d_f32(ctx->beatTime, ctx->beatAmp, numValid, ctx->gridTime, ctx->ampSig, numGrid);
+    pk_standardize_f32(ctx->edrSig, ctx->edrSig, numGrid, 1e-6f);
+    pk_standardize_f32(ctx->ampSig, ctx->ampSig, numGrid, 1e-6f);
+    for (size_t i = 0; i < numGrid; i++)
+    {
+        ctx->edrSig[i] = (1.0f - ctx->ampWeight) * ctx->edrSig[i] + ctx->ampWeight * ctx->ampSig[i];
+    }
+
+    // Bandpass to respiratory band (fresh filter state per window)
+    memset(ctx->filterState, 0, sizeof(ctx->filterState));
+    pk_apply_biquad_filter_f32(&ctx->filter, ctx->edrSig, ctx->edrSig, numGrid);
+    memset(&ctx->edrSig[numGrid], 0, (ctx->fftLen - numGrid) * sizeof(float32_t));
+
+    // Power spectrum peak within respiratory band
+    arm_rfft_fast_f32(&ctx->fftCtx, ctx->edrSig, ctx->spec, 0);
+    float32_t binWidth = (float32_t)ctx->interpRate / ctx->fftLen;
+    uint32_t loBin = (uint32_t)ceilf(ctx->lowFreq / binWidth);
+    uint32_t hiBin = (uint32_t)(ctx->highFreq / binWidth);
+    loBin = loBin < 1 ? 1 : loBin;
+    hiBin = hiBin > ctx->fftLen / 2 - 2 ? ctx->fftLen / 2 - 2 : hiBin;
+    uint32_t peakBin = 0;
+    float32_t peakPow = 0, pow;
+    for (size_t k = loBin; k <= hiBin; k++)
+    {
+        pow = ctx->spec[2 * k] * ctx->spec[2 * k] + ctx->spec[2 * k + 1] * ctx->spec[2 * k + 1];
+        if (pow > peakPow)
+        {
+            peakPow = pow;
+            peakBin = k;
+        }
+    }
+    if (peakBin == 0)
+    {
+        return 1;
+    }
+    // Parabolic interpolation of peak on log power (bin 0 slot packs DC and Nyquist reals)
+    float32_t pm = peakBin == 1 ? ctx->spec[0] * ctx->spec[0]
+                                : ctx->spec[2 * peakBin - 2] * ctx->spec[2 * peakBin - 2] + ctx->spec[2 * peakBin - 1] * ctx->spec[2 * peakBin - 1];
+    float32_t pp = ctx->spec[2 * peakBin + 2] * ctx->spec[2 * peakBin + 2] + ctx->spec[2 * peakBin + 3] * ctx->spec[2 * peakBin + 3];
+    float32_t delta = 0;
+    if (pm > 0 && pp > 0)
+    {
+        float32_t lm = logf(pm), l0 = logf(peakPow), lp = logf(pp);
+        float32_t den = lm - 2 * l0 + lp;
+        delta = den < 0 ? 0.5f * (lm - lp) / den : 0;
+    }
+    *respRate = 60.0f * (peakBin + delta) * binWidth;
+    return 0;
 }
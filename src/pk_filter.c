@@ -9,41 +9,423 @@
  *
  */
 #include <math.h>
+#include <string.h>
 #include "arm_math.h"
 
+#include "pk_config.h"
+#include "pk_dsp.h"
 #include "pk_math.h"
 #include "pk_filter.h"
 
+#if PK_BATCH_THREADS
+#include <pthread.h>
+#endif
+
+static uint32_t
+pk_gcd_u32(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+uint32_t
+pk_design_resample_bank_f32(float32_t *bank, uint32_t upSample, uint32_t downSample, uint32_t tapsPerPhase)
+{
+    if (upSample == 0 || downSample == 0 || tapsPerPhase == 0)
+    {
+        return 1;
+    }
+    uint32_t g = pk_gcd_u32(upSample, downSample);
+    upSample /= g;
+    downSample /= g;
+    uint32_t numTaps = upSample * tapsPerPhase;
+    // Cutoff in cycles per upsampled sample
+    float32_t fc = 0.5f / (upSample > downSample ? upSample : downSample);
+    float32_t center = 0.5f * (numTaps - 1);
+    float32_t sum = 0;
+    float32_t h, t, n;
+    for (size_t m = 0; m < numTaps; m++)
+    {
+        t = m - center;
+        h = t == 0 ? 2.0f * fc : sinf(2.0f * PI * fc * t) / (PI * t);
+        n = 2.0f * m - numTaps + 1;
+        h *= numTaps > 1 ? 0.42f + 0.5f * cosf(PI * n / (numTaps - 1)) + 0.08f * cosf(2.0f * PI * n / (numTaps - 1)) : 1.0f;
+        // Branch p holds taps m = k*L + p with newest input last
+        bank[(m % upSample) * tapsPerPhase + (tapsPerPhase - 1 - m / upSample)] = h;
+        sum += h;
+    }
+    // Unity DC gain per branch (upsample gain L)
+    pk_dsp_scale_f32(bank, upSample / sum, bank, numTaps);
+    return 0;
+}
+
+uint32_t
+pk_resample_state_size_f32(resample_f32_t *ctx)
+{
+    // Input history is stored twice (see pk_resample_signal_f32)
+    return 2 * ctx->tapsPerPhase;
+}
+
+uint32_t
+pk_init_resample_f32(resample_f32_t *ctx)
+{
+    if (ctx->upSample == 0 || ctx->downSample == 0 || ctx->tapsPerPhase == 0)
+    {
+        return 1;
+    }
+    uint32_t g = pk_gcd_u32(ctx->upSample, ctx->downSample);
+    ctx->upSample /= g;
+    ctx->downSample /= g;
+    ctx->phase = 0;
+    ctx->histIdx = 0;
+    for (size_t i = 0; i < 2 * ctx->tapsPerPhase; i++)
+    {
+        ctx->state[i] = 0;
+    }
+    return 0;
+}
+
 uint32_t
-pk_resample_signal_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, uint32_t upSample, uint32_t downSample)
+pk_resample_signal_f32(resample_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
+{
+    // History is stored twice so the last tapsPerPhase inputs are always contiguous
+    uint32_t taps = ctx->tapsPerPhase;
+    uint32_t numOut = 0;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        ctx->histIdx = ctx->histIdx + 1 == taps ? 0 : ctx->histIdx + 1;
+        ctx->state[ctx->histIdx] = pSrc[i];
+        ctx->state[ctx->histIdx + taps] = pSrc[i];
+        // Emit every output whose upsampled time falls before next input
+        while (ctx->phase < ctx->upSample)
+        {
+            pk_dsp_dot_prod_f32(&ctx->bank[ctx->phase * taps], &ctx->state[ctx->histIdx + 1], taps, &pResult[numOut++]);
+            ctx->phase += ctx->downSample;
+        }
+        ctx->phase -= ctx->upSample;
+    }
+    return numOut;
+}
+
+static inline int32_t
+pk_floor_div_i32(int32_t a, int32_t b)
 {
-    return 1;
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static uint32_t
+pk_resample_categorical_hist_len(resample_u32_t *ctx)
+{
+    uint32_t g = pk_gcd_u32(ctx->upSample, ctx->downSample);
+    uint32_t up = ctx->upSample / g, down = ctx->downSample / g;
+    uint32_t delay = ctx->tapsPerPhase ? up * ctx->tapsPerPhase - 1 : (down > up ? down - up : 0);
+    // Furthest label behind newest input reached by a vote window
+    return (delay + down) / (2 * up) + 2;
+}
+
+static uint32_t
+pk_resample_categorical_tally_bits(uint32_t histLen)
+{
+    // Open addressed vote table at most half full
+    uint32_t bits = 1;
+    while ((1U << bits) < 2 * histLen)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+uint32_t
+pk_resample_categorical_state_size_u32(resample_u32_t *ctx)
+{
+    uint32_t histLen = pk_resample_categorical_hist_len(ctx);
+    uint32_t up = ctx->upSample / pk_gcd_u32(ctx->upSample, ctx->downSample);
+    // History + per-phase window bounds + vote table {label, count, dist, first, stamp}
+    return histLen + 2 * up + 5 * (1U << pk_resample_categorical_tally_bits(histLen));
+}
+
+uint32_t
+pk_init_resample_categorical_u32(resample_u32_t *ctx)
+{
+    if (ctx->upSample == 0 || ctx->downSample == 0)
+    {
+        return 1;
+    }
+    ctx->histLen = pk_resample_categorical_hist_len(ctx);
+    ctx->tallyBits = pk_resample_categorical_tally_bits(ctx->histLen);
+    uint32_t g = pk_gcd_u32(ctx->upSample, ctx->downSample);
+    ctx->upSample /= g;
+    ctx->downSample /= g;
+    // Match FIR group delay, otherwise delay vote windows so they end at the output time
+    if (ctx->tapsPerPhase)
+    {
+        ctx->delay = ctx->upSample * ctx->tapsPerPhase - 1;
+    }
+    else
+    {
+        ctx->delay = ctx->downSample > ctx->upSample ? ctx->downSample - ctx->upSample : 0;
+    }
+    ctx->phase = 0;
+    ctx->histIdx = 0;
+    ctx->runLen = ctx->histLen;
+    ctx->tallyStamp = 0;
+    memset(ctx->state, 0, pk_resample_categorical_state_size_u32(ctx) * sizeof(uint32_t));
+
+    // Window of each phase relative to newest input, so no divides per output
+    // Times are in units of 1/(2L) input samples
+    int32_t *bounds = (int32_t *)&ctx->state[ctx->histLen];
+    int32_t up2 = 2 * ctx->upSample;
+    int32_t down = ctx->downSample;
+    int32_t histLen = ctx->histLen;
+    int32_t center, lo, hi;
+    for (size_t p = 0; p < ctx->upSample; p++)
+    {
+        center = 2 * (int32_t)p - ctx->delay;
+        // Labels whose cell centers fall within [center - M, center + M)
+        lo = -pk_floor_div_i32(down - center, up2);
+        hi = -pk_floor_div_i32(-center - down, up2) - 1;
+        if (hi < lo)
+        {
+            // Upsampling- nearest label
+            lo = hi = pk_floor_div_i32(center + ctx->upSample, up2);
+        }
+        hi = hi > 0 ? 0 : hi;
+        lo = lo > hi ? hi : lo;
+        lo = lo < 1 - histLen ? 1 - histLen : lo;
+        bounds[2 * p] = lo;
+        bounds[2 * p + 1] = hi;
+    }
+    return 0;
+}
+
+static inline uint32_t
+pk_categorical_hist_idx(resample_u32_t *ctx, int32_t offset)
+{
+    // Offset is relative to newest label (0) and no older than 1 - histLen
+    int32_t idx = (int32_t)ctx->histIdx + offset;
+    return idx < 0 ? idx + ctx->histLen : idx;
+}
+
+static uint32_t
+pk_resample_categorical_vote(resample_u32_t *ctx, int32_t lo, int32_t hi, int32_t center)
+{
+    // Plurality over runs of equal labels, ties go to the label nearest center
+    int32_t up2 = 2 * ctx->upSample;
+    uint32_t tabMask = (1U << ctx->tallyBits) - 1;
+    uint32_t *labels = &ctx->state[ctx->histLen + 2 * ctx->upSample];
+    uint32_t *counts = &labels[tabMask + 1];
+    uint32_t *dists = &counts[tabMask + 1];
+    uint32_t *firsts = &dists[tabMask + 1];
+    uint32_t *stamps = &firsts[tabMask + 1];
+    if (++ctx->tallyStamp == 0)
+    {
+        memset(stamps, 0, (tabMask + 1) * sizeof(uint32_t));
+        ctx->tallyStamp = 1;
+    }
+    uint32_t stamp = ctx->tallyStamp;
+    uint32_t label = 0, count = 0, dist = UINT32_MAX, first = 0;
+    uint32_t cand, h;
+    int32_t nearest = pk_floor_div_i32(center + ctx->upSample, up2);
+    int32_t k, run, j, d;
+    for (k = lo; k <= hi; k = run)
+    {
+        cand = ctx->state[pk_categorical_hist_idx(ctx, k)];
+        for (run = k + 1; run <= hi && ctx->state[pk_categorical_hist_idx(ctx, run)] == cand; run++)
+            ;
+        // Distance is convex in position so the clamped nearest label is closest in run
+        j = nearest < k ? k : (nearest >= run ? run - 1 : nearest);
+        d = j * up2 - center;
+        d = d < 0 ? -d : d;
+        h = (cand * 2654435761U) >> (32 - ctx->tallyBits);
+        while (stamps[h] == stamp && labels[h] != cand)
+        {
+            h = (h + 1) & tabMask;
+        }
+        if (stamps[h] != stamp)
+        {
+            stamps[h] = stamp;
+            labels[h] = cand;
+            counts[h] = 0;
+            dists[h] = UINT32_MAX;
+            firsts[h] = k - lo;
+        }
+        counts[h] += run - k;
+        dists[h] = (uint32_t)d < dists[h] ? (uint32_t)d : dists[h];
+        // Equally near labels (either side of center) go to the older one
+        if (counts[h] > count || (counts[h] == count && (dists[h] < dist || (dists[h] == dist && firsts[h] < first))))
+        {
+            label = cand;
+            count = counts[h];
+            dist = dists[h];
+            first = firsts[h];
+        }
+    }
+    return label;
 }
 
 uint32_t
-pk_resample_categorical_u32(uint32_t *pSrc, uint32_t *pResult, uint32_t blockSize, uint32_t upSample, uint32_t downSample)
+pk_resample_categorical_u32(resample_u32_t *ctx, uint32_t *pSrc, uint32_t *pResult, uint32_t blockSize)
 {
-    return 1;
+    const int32_t *bounds = (const int32_t *)&ctx->state[ctx->histLen];
+    uint32_t *hist = ctx->state;
+    uint32_t histLen = ctx->histLen;
+    uint32_t histIdx = ctx->histIdx;
+    uint32_t runLen = ctx->runLen;
+    uint32_t phase = ctx->phase;
+    uint32_t up = ctx->upSample, down = ctx->downSample;
+    uint32_t numOut = 0;
+    int32_t lo, hi;
+    if (up == down)
+    {
+        // L == M windows hold one label, so this is a pure delay of -lo labels
+        lo = bounds[0];
+        size_t i = 0;
+        if (lo == 0)
+        {
+            memcpy(pResult, pSrc, blockSize * sizeof(uint32_t));
+            i = blockSize > histLen ? blockSize - histLen : 0;
+        }
+        for (; i < blockSize; i++)
+        {
+            histIdx = histIdx + 1 == histLen ? 0 : histIdx + 1;
+            hist[histIdx] = pSrc[i];
+            pResult[i] = hist[(int32_t)histIdx + lo < 0 ? histIdx + lo + histLen : histIdx + lo];
+        }
+        ctx->histIdx = histIdx;
+        return blockSize;
+    }
+    uint32_t prev = hist[histIdx];
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        runLen = pSrc[i] != prev ? 1 : (runLen < histLen ? runLen + 1 : runLen);
+        prev = pSrc[i];
+        histIdx = histIdx + 1 == histLen ? 0 : histIdx + 1;
+        hist[histIdx] = pSrc[i];
+        for (; phase < up; phase += down)
+        {
+            lo = bounds[2 * phase];
+            // Window within the newest run copies its label through
+            if (lo > -(int32_t)runLen)
+            {
+                pResult[numOut++] = pSrc[i];
+                continue;
+            }
+            hi = bounds[2 * phase + 1];
+            ctx->histIdx = histIdx;
+            pResult[numOut++] = pk_resample_categorical_vote(ctx, lo, hi, 2 * (int32_t)phase - ctx->delay);
+        }
+        phase -= up;
+    }
+    ctx->histIdx = histIdx;
+    ctx->runLen = runLen;
+    ctx->phase = phase;
+    return numOut;
 }
 
 uint32_t
 pk_linear_downsample_f32(float32_t *pSrc, uint32_t srcSize, uint32_t srcFs, float32_t *pRst, uint32_t rstSize, uint32_t rstFs)
 {
-    float32_t xi, yl, yr;
-    uint32_t xl, xr;
-    float32_t ratio = ((float32_t)srcFs) / rstFs;
+    if (srcSize == 0 || srcFs == 0 || rstFs == 0)
+    {
+        return 1;
+    }
+    // Position of output i is idx + frac/rstFs with frac in [0, rstFs)
+    uint32_t g = pk_gcd_u32(srcFs, rstFs);
+    uint32_t srcStep = srcFs / g, rstStep = rstFs / g;
+    uint32_t idxStep = srcStep / rstStep, fracStep = srcStep % rstStep;
+    float32_t fracScale = 1.0f / rstStep;
+    uint32_t idx = 0, frac = 0;
     for (size_t i = 0; i < rstSize; i++)
     {
-        xi = i * ratio;
-        xl = floorf(xi);
-        xr = ceilf(xi);
-        yl = pSrc[xl];
-        yr = pSrc[xr];
-        pRst[i] = xl == xr ? yl : yl + (xi - xl) * ((yr - yl) / (xr - xl));
+        if (idx + 1 < srcSize)
+        {
+            pRst[i] = pSrc[idx] + frac * fracScale * (pSrc[idx + 1] - pSrc[idx]);
+        }
+        else
+        {
+            pRst[i] = pSrc[srcSize - 1];
+        }
+        idx += idxStep;
+        frac += fracStep;
+        if (frac >= rstStep)
+        {
+            frac -= rstStep;
+            idx++;
+        }
+    }
+    return 0;
+}
+
+uint32_t
+pk_init_interp_resample_f32(interp_resample_f32_t *ctx)
+{
+    if (ctx->srcRate == 0 || ctx->dstRate == 0)
+    {
+        return 1;
+    }
+    uint32_t g = pk_gcd_u32(ctx->srcRate, ctx->dstRate);
+    ctx->srcRate /= g;
+    ctx->dstRate /= g;
+    ctx->phase = 0;
+    ctx->phaseScale = 1.0f / ctx->dstRate;
+    ctx->numSeen = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        ctx->hist[i] = 0;
     }
     return 0;
 }
 
+uint32_t
+pk_interp_resample_f32(interp_resample_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
+{
+    // Segment [h1, h2] (cubic, h0/h3 neighbors) or [h2, h3] (linear)
+    float32_t *h = ctx->hist;
+    uint32_t primed = ctx->cubic ? 3 : 2;
+    uint32_t numOut = 0;
+    float32_t t;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        h[0] = h[1];
+        h[1] = h[2];
+        h[2] = h[3];
+        h[3] = pSrc[i];
+        if (ctx->numSeen < 4)
+        {
+            ctx->numSeen++;
+            if (ctx->numSeen == 1)
+            {
+                // Replicate first sample as left edge
+                h[0] = h[1] = h[2] = h[3];
+            }
+            if (ctx->numSeen < primed)
+            {
+                continue;
+            }
+        }
+        while (ctx->phase < ctx->dstRate)
+        {
+            t = ctx->phase * ctx->phaseScale;
+            if (ctx->cubic)
+            {
+                pResult[numOut++] = h[1] + 0.5f * t * (h[2] - h[0] + t * (2.0f * h[0] - 5.0f * h[1] + 4.0f * h[2] - h[3] + t * (3.0f * (h[1] - h[2]) + h[3] - h[0])));
+            }
+            else
+            {
+                pResult[numOut++] = h[2] + t * (h[3] - h[2]);
+            }
+            ctx->phase += ctx->srcRate;
+        }
+        ctx->phase -= ctx->dstRate;
+    }
+    return numOut;
+}
+
 uint32_t
 pk_blackman_coefs_f32(float32_t *coefs, uint32_t len)
 {
@@ -55,6 +437,277 @@ pk_blackman_coefs_f32(float32_t *coefs, uint32_t len)
     return 0;
 }
 
+#define PK_PI_F64 (3.14159265358979323846)
+
+typedef struct
+{
+    double re;
+    double im;
+} pk_cplx_t;
+
+static inline pk_cplx_t
+pk_cplx(double re, double im)
+{
+    pk_cplx_t z = {re, im};
+    return z;
+}
+
+static inline pk_cplx_t
+pk_cplx_mul(pk_cplx_t a, pk_cplx_t b)
+{
+    return pk_cplx(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+
+static inline pk_cplx_t
+pk_cplx_div(pk_cplx_t a, pk_cplx_t b)
+{
+    double d = b.re * b.re + b.im * b.im;
+    return pk_cplx((a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d);
+}
+
+static inline pk_cplx_t
+pk_cplx_sqrt(pk_cplx_t a)
+{
+    double r = sqrt(sqrt(a.re * a.re + a.im * a.im));
+    double t = 0.5 * atan2(a.im, a.re);
+    return pk_cplx(r * cos(t), r * sin(t));
+}
+
+static inline pk_cplx_t
+pk_bilinear(pk_cplx_t s, double fs2)
+{
+    return pk_cplx_div(pk_cplx(fs2 + s.re, s.im), pk_cplx(fs2 - s.re, -s.im));
+}
+
+static void
+pk_filter_design_section(float32_t *sec, pk_cplx_t za, pk_cplx_t zb, const double *b, pk_cplx_t zRef)
+{
+    // Denominator (1 - za z^-1)(1 - zb z^-1), scaled to unit gain at zRef
+    double a1 = za.re + zb.re;
+    double a2 = pk_cplx_mul(za, zb).re;
+    pk_cplx_t zi = pk_cplx_div(pk_cplx(1, 0), zRef);
+    pk_cplx_t zi2 = pk_cplx_mul(zi, zi);
+    pk_cplx_t num = pk_cplx(b[0] + b[1] * zi.re + b[2] * zi2.re, b[1] * zi.im + b[2] * zi2.im);
+    pk_cplx_t den = pk_cplx(1 - a1 * zi.re + a2 * zi2.re, -a1 * zi.im + a2 * zi2.im);
+    double g = sqrt((den.re * den.re + den.im * den.im) / (num.re * num.re + num.im * num.im));
+    sec[0] = g * b[0];
+    sec[1] = g * b[1];
+    sec[2] = g * b[2];
+    sec[3] = a1;
+    sec[4] = -a2;
+}
+
+#if PK_FILTER_DESIGN_CACHE_SIZE > 0
+typedef struct
+{
+    filter_design_f32_t design;
+    uint32_t stamp; // 0 = empty
+    float32_t sos[5 * PK_FILTER_DESIGN_CACHE_SECS];
+} pk_filter_design_cache_t;
+
+static pk_filter_design_cache_t pkFilterDesignCache[PK_FILTER_DESIGN_CACHE_SIZE];
+static uint32_t pkFilterDesignStamp = 0;
+
+#if PK_BATCH_THREADS
+// Lookups update LRU stamps, so hits need the lock too
+static pthread_mutex_t pkFilterDesignLock = PTHREAD_MUTEX_INITIALIZER;
+#define PK_FILTER_DESIGN_LOCK() pthread_mutex_lock(&pkFilterDesignLock)
+#define PK_FILTER_DESIGN_UNLOCK() pthread_mutex_unlock(&pkFilterDesignLock)
+#else
+#define PK_FILTER_DESIGN_LOCK()
+#define PK_FILTER_DESIGN_UNLOCK()
+#endif
+
+static uint8_t
+pk_filter_design_equal(const filter_design_f32_t *a, const filter_design_f32_t *b)
+{
+    return a->family == b->family && a->type == b->type && a->order == b->order && a->lowcut == b->lowcut &&
+           a->highcut == b->highcut && a->ripple == b->ripple && a->sampleRate == b->sampleRate;
+}
+
+static uint8_t
+pk_filter_design_cache_get(const filter_design_f32_t *design, float32_t *sos, uint32_t numSecs)
+{
+    uint8_t hit = 0;
+    PK_FILTER_DESIGN_LOCK();
+    for (size_t i = 0; i < PK_FILTER_DESIGN_CACHE_SIZE; i++)
+    {
+        pk_filter_design_cache_t *c = &pkFilterDesignCache[i];
+        if (c->stamp != 0 && pk_filter_design_equal(&c->design, design))
+        {
+            c->stamp = ++pkFilterDesignStamp;
+            memcpy(sos, c->sos, 5 * numSecs * sizeof(float32_t));
+            hit = 1;
+            break;
+        }
+    }
+    PK_FILTER_DESIGN_UNLOCK();
+    return hit;
+}
+
+static void
+pk_filter_design_cache_put(const filter_design_f32_t *design, const float32_t *sos, uint32_t numSecs)
+{
+    if (numSecs > PK_FILTER_DESIGN_CACHE_SECS)
+    {
+        return;
+    }
+    PK_FILTER_DESIGN_LOCK();
+    // Evict least recently used
+    pk_filter_design_cache_t *slot = &pkFilterDesignCache[0];
+    for (size_t i = 1; i < PK_FILTER_DESIGN_CACHE_SIZE; i++)
+    {
+        pk_filter_design_cache_t *c = &pkFilterDesignCache[i];
+        slot = c->stamp < slot->stamp ? c : slot;
+    }
+    slot->design = *design;
+    slot->stamp = ++pkFilterDesignStamp;
+    memcpy(slot->sos, sos, 5 * numSecs * sizeof(float32_t));
+    PK_FILTER_DESIGN_UNLOCK();
+}
+#endif
+
+uint32_t
+pk_filter_design_num_sections(const filter_design_f32_t *design)
+{
+    if (design->type == PK_FILTER_BANDPASS || design->type == PK_FILTER_BANDSTOP)
+    {
+        return design->order;
+    }
+    return (design->order + 1) / 2;
+}
+
+uint32_t
+pk_design_biquad_filter_f32(const filter_design_f32_t *design, float32_t *sos)
+{
+    uint32_t numSecs = pk_filter_design_num_sections(design);
+    uint32_t order = design->order;
+    uint8_t isBand = design->type == PK_FILTER_BANDPASS || design->type == PK_FILTER_BANDSTOP;
+    double fs = design->sampleRate;
+    if (order == 0 || design->type > PK_FILTER_BANDSTOP || design->family > PK_FILTER_CHEBYSHEV1 || design->lowcut <= 0 ||
+        design->lowcut >= 0.5 * fs || (isBand && (design->highcut <= design->lowcut || design->highcut >= 0.5 * fs)) ||
+        (design->family == PK_FILTER_CHEBYSHEV1 && design->ripple <= 0))
+    {
+        return 1;
+    }
+
+#if PK_FILTER_DESIGN_CACHE_SIZE > 0
+    if (pk_filter_design_cache_get(design, sos, numSecs))
+    {
+        return 0;
+    }
+#endif
+
+    // Prewarped analog edges (rad/s)
+    double fs2 = 2.0 * fs;
+    double w1 = fs2 * tan(PK_PI_F64 * design->lowcut / fs);
+    double w2 = isBand ? fs2 * tan(PK_PI_F64 * design->highcut / fs) : w1;
+    double bw = w2 - w1;
+    double w0 = sqrt(w1 * w2);
+
+    // Prototype: poles -sinh(mu)sin(t) + j cosh(mu)cos(t); Butterworth has mu -> inf normalized (sinh = cosh = 1)
+    double sh = 1.0, ch = 1.0, gain = 1.0;
+    if (design->family == PK_FILTER_CHEBYSHEV1)
+    {
+        double eps = sqrt(pow(10.0, 0.1 * design->ripple) - 1.0);
+        double mu = asinh(1.0 / eps) / order;
+        sh = sinh(mu);
+        ch = cosh(mu);
+        gain = order % 2 == 0 ? 1.0 / sqrt(1.0 + eps * eps) : 1.0;
+    }
+
+    // Section zeros and unit-gain reference point
+    double b[3];
+    pk_cplx_t zRef;
+    double theta0 = 2.0 * atan(w0 / fs2);
+    switch (design->type)
+    {
+    case PK_FILTER_LOWPASS:
+        b[0] = 1, b[1] = 2, b[2] = 1;
+        zRef = pk_cplx(1, 0);
+        break;
+    case PK_FILTER_HIGHPASS:
+        b[0] = 1, b[1] = -2, b[2] = 1;
+        zRef = pk_cplx(-1, 0);
+        break;
+    case PK_FILTER_BANDPASS:
+        b[0] = 1, b[1] = 0, b[2] = -1;
+        zRef = pk_cplx(cos(theta0), sin(theta0));
+        break;
+    default:
+        b[0] = 1, b[1] = -2.0 * cos(theta0), b[2] = 1;
+        zRef = pk_cplx(1, 0);
+        break;
+    }
+
+    uint32_t sec = 0;
+    pk_cplx_t p, s1, s2, z1, z2, d;
+    for (size_t k = 0; k < (order + 1) / 2; k++)
+    {
+        double t = PK_PI_F64 * (2.0 * k + 1) / (2.0 * order);
+        uint8_t isReal = 2 * k + 1 == order;
+        p = pk_cplx(-sh * sin(t), isReal ? 0 : ch * cos(t));
+        switch (design->type)
+        {
+        case PK_FILTER_LOWPASS:
+        case PK_FILTER_HIGHPASS:
+            s1 = design->type == PK_FILTER_LOWPASS ? pk_cplx(w1 * p.re, w1 * p.im) : pk_cplx_div(pk_cplx(w1, 0), p);
+            z1 = pk_bilinear(s1, fs2);
+            if (isReal)
+            {
+                // First order section
+                double b1[3] = {1, design->type == PK_FILTER_LOWPASS ? 1 : -1, 0};
+                pk_filter_design_section(&sos[5 * sec++], z1, pk_cplx(0, 0), b1, zRef);
+            }
+            else
+            {
+                pk_filter_design_section(&sos[5 * sec++], z1, pk_cplx(z1.re, -z1.im), b, zRef);
+            }
+            break;
+        default:
+            // Each prototype pole maps to s = h +/- sqrt(h^2 - w0^2)
+            d = design->type == PK_FILTER_BANDPASS ? pk_cplx(0.5 * bw * p.re, 0.5 * bw * p.im) : pk_cplx_div(pk_cplx(0.5 * bw, 0), p);
+            s2 = pk_cplx_sqrt(pk_cplx(d.re * d.re - d.im * d.im - w0 * w0, 2 * d.re * d.im));
+            s1 = pk_cplx(d.re + s2.re, d.im + s2.im);
+            s2 = pk_cplx(d.re - s2.re, d.im - s2.im);
+            z1 = pk_bilinear(s1, fs2);
+            z2 = pk_bilinear(s2, fs2);
+            if (isReal)
+            {
+                pk_filter_design_section(&sos[5 * sec++], z1, z2, b, zRef);
+            }
+            else
+            {
+                pk_filter_design_section(&sos[5 * sec++], z1, pk_cplx(z1.re, -z1.im), b, zRef);
+                pk_filter_design_section(&sos[5 * sec++], z2, pk_cplx(z2.re, -z2.im), b, zRef);
+            }
+            break;
+        }
+    }
+
+    // Order sections by pole radius (furthest from unit circle first)
+    float32_t tmp[5];
+    for (size_t i = 1; i < numSecs; i++)
+    {
+        memcpy(tmp, &sos[5 * i], sizeof(tmp));
+        size_t j = i;
+        while (j > 0 && fabsf(sos[5 * (j - 1) + 4]) > fabsf(tmp[4]))
+        {
+            memcpy(&sos[5 * j], &sos[5 * (j - 1)], sizeof(tmp));
+            j--;
+        }
+        memcpy(&sos[5 * j], tmp, sizeof(tmp));
+    }
+    sos[0] *= gain;
+    sos[1] *= gain;
+    sos[2] *= gain;
+
+#if PK_FILTER_DESIGN_CACHE_SIZE > 0
+    pk_filter_design_cache_put(design, sos, numSecs);
+#endif
+    return 0;
+}
+
 uint32_t
 pk_init_biquad_filter_f32(arm_biquad_casd_df1_inst_f32 *ctx)
 {
@@ -65,32 +718,188 @@ pk_init_biquad_filter_f32(arm_biquad_casd_df1_inst_f32 *ctx)
 uint32_t
 pk_apply_biquad_filter_f32(arm_biquad_casd_df1_inst_f32 *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
 {
-    arm_biquad_cascade_df1_f32(ctx, pSrc, pResult, blockSize);
+    pk_dsp_biquad_df1_f32(ctx, pSrc, pResult, blockSize);
     return 0;
 }
 
+uint32_t
+pk_init_biquad_multi_f32(biquad_multi_f32_t *ctx, const float32_t *sos, uint8_t perChannel)
+{
+    uint32_t nc = ctx->numChannels;
+    uint32_t ns = ctx->numStages;
+    const float32_t *k;
+    if (nc == 0)
+    {
+        return 1;
+    }
+    for (size_t c = 0; c < nc; c++)
+    {
+        k = perChannel ? &sos[5 * ns * c] : sos;
+        for (size_t s = 0; s < ns; s++, k += 5)
+        {
+            for (size_t j = 0; j < 5; j++)
+            {
+                ctx->pCoeffs[(5 * s + j) * nc + c] = k[j];
+            }
+        }
+    }
+    memset(ctx->pState, 0, 4 * ns * nc * sizeof(float32_t));
+    return 0;
+}
+
+uint32_t
+pk_apply_biquad_multi_f32(biquad_multi_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
+{
+    pk_dsp_biquad_df1_multi_f32(ctx, pSrc, pResult, blockSize);
+    return 0;
+}
+
+static void
+pk_biquad_steady_state_f32(arm_biquad_casd_df1_inst_f32 *ctx, float32_t value)
+{
+    // DF1 state {x1, x2, y1, y2} per stage for constant input to cascade
+    const float32_t *c = ctx->pCoeffs;
+    float32_t *st = ctx->pState;
+    for (size_t s = 0; s < ctx->numStages; s++, c += 5, st += 4)
+    {
+        float32_t den = 1.0f - c[3] - c[4];
+        float32_t out = den != 0 ? value * (c[0] + c[1] + c[2]) / den : 0;
+        st[0] = st[1] = value;
+        st[2] = st[3] = out;
+        value = out;
+    }
+}
+
+static void
+pk_reverse_f32(float32_t *x, uint32_t len)
+{
+    float32_t t;
+    for (size_t i = 0, j = len - 1; i < len / 2; i++, j--)
+    {
+        t = x[i];
+        x[i] = x[j];
+        x[j] = t;
+    }
+}
+
+uint32_t
+pk_biquad_filtfilt_state_size_f32(arm_biquad_casd_df1_inst_f32 *ctx)
+{
+    return 3 * (2 * ctx->numStages + 1);
+}
+
 uint32_t
 pk_apply_biquad_filtfilt_f32(arm_biquad_casd_df1_inst_f32 *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize, float32_t *state)
 {
-    // Forward pass
-    arm_fill_f32(0, ctx->pState, 4 * ctx->numStages);
-    arm_biquad_cascade_df1_f32(ctx, pSrc, pResult, blockSize);
+    if (blockSize < 2)
+    {
+        if (blockSize == 1)
+        {
+            pResult[0] = pSrc[0];
+        }
+        return blockSize == 1 ? 0 : 1;
+    }
+    uint32_t padLen = pk_biquad_filtfilt_state_size_f32(ctx);
+    padLen = padLen < blockSize ? padLen : blockSize - 1;
+    float32_t *pad = state;
+    float32_t first = pSrc[0];
+    float32_t last = pSrc[blockSize - 1];
 
-    for (size_t i = 0; i < blockSize; i++)
+    // Forward pass: left odd extension, signal, right odd extension
+    for (size_t i = 0; i < padLen; i++)
+    {
+        pad[i] = 2.0f * first - pSrc[padLen - i];
+    }
+    pk_biquad_steady_state_f32(ctx, pad[0]);
+    pk_dsp_biquad_df1_f32(ctx, pad, pad, padLen);
+    // pResult may alias pSrc- build right extension before it is overwritten
+    for (size_t i = 0; i < padLen; i++)
     {
-        state[i] = pResult[blockSize - 1 - i];
+        pad[i] = 2.0f * last - pSrc[blockSize - 2 - i];
     }
+    pk_dsp_biquad_df1_f32(ctx, pSrc, pResult, blockSize);
+    pk_dsp_biquad_df1_f32(ctx, pad, pad, padLen);
 
-    // Backward pass
-    arm_fill_f32(0, ctx->pState, 4 * ctx->numStages);
-    arm_biquad_cascade_df1_f32(ctx, state, pResult, blockSize);
-    for (size_t i = 0; i < blockSize; i++)
+    // Backward pass: reversed right extension, then reversed signal (in place)
+    pk_reverse_f32(pad, padLen);
+    pk_biquad_steady_state_f32(ctx, pad[0]);
+    pk_dsp_biquad_df1_f32(ctx, pad, pad, padLen);
+    pk_reverse_f32(pResult, blockSize);
+    pk_dsp_biquad_df1_f32(ctx, pResult, pResult, blockSize);
+    pk_reverse_f32(pResult, blockSize);
+    return 0;
+}
+
+uint32_t
+pk_biquad_filtfilt_stream_state_size_f32(biquad_filtfilt_stream_f32_t *ctx)
+{
+    return 8 * ctx->numStages + 2 * (ctx->hopSize + ctx->lookahead);
+}
+
+uint32_t
+pk_init_biquad_filtfilt_stream_f32(biquad_filtfilt_stream_f32_t *ctx)
+{
+    if (ctx->hopSize == 0)
     {
-        state[i] = pResult[blockSize - 1 - i];
+        return 1;
     }
-    for (size_t i = 0; i < blockSize; i++)
+    uint32_t winLen = ctx->hopSize + ctx->lookahead;
+    arm_biquad_cascade_df1_init_f32(&ctx->fwd, ctx->numStages, ctx->coeffs, &ctx->state[0]);
+    arm_biquad_cascade_df1_init_f32(&ctx->bwd, ctx->numStages, ctx->coeffs, &ctx->state[4 * ctx->numStages]);
+    ctx->fwdBuf = &ctx->state[8 * ctx->numStages];
+    ctx->bwdBuf = &ctx->fwdBuf[winLen];
+    ctx->fwdLen = 0;
+    ctx->readyIdx = 0;
+    ctx->primed = 0;
+    ctx->ready = 0;
+    return 0;
+}
+
+uint32_t
+pk_apply_biquad_filtfilt_stream_f32(biquad_filtfilt_stream_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
+{
+    uint32_t winLen = ctx->hopSize + ctx->lookahead;
+    uint32_t n;
+    if (!ctx->primed && blockSize > 0)
     {
-        pResult[i] = state[i];
+        pk_biquad_steady_state_f32(&ctx->fwd, pSrc[0]);
+        ctx->primed = 1;
+    }
+    while (blockSize > 0)
+    {
+        // Chunk never exceeds hopSize once the first window has filled
+        n = winLen - ctx->fwdLen;
+        n = n < blockSize ? n : blockSize;
+        pk_dsp_biquad_df1_f32(&ctx->fwd, pSrc, &ctx->fwdBuf[ctx->fwdLen], n);
+        ctx->fwdLen += n;
+
+        // Emit finalized samples of previous window (oldest first)
+        for (size_t i = 0; i < n; i++)
+        {
+            pResult[i] = ctx->ready ? ctx->bwdBuf[winLen - 1 - ctx->readyIdx++] : 0;
+        }
+        pSrc += n;
+        pResult += n;
+        blockSize -= n;
+
+        if (ctx->fwdLen == winLen)
+        {
+            // Backward pass over reversed window- first lookahead outputs settle the state
+            for (size_t i = 0; i < winLen; i++)
+            {
+                ctx->bwdBuf[i] = ctx->fwdBuf[winLen - 1 - i];
+            }
+            pk_biquad_steady_state_f32(&ctx->bwd, ctx->bwdBuf[0]);
+            pk_dsp_biquad_df1_f32(&ctx->bwd, ctx->bwdBuf, ctx->bwdBuf, winLen);
+            // Keep lookahead for next window
+            for (size_t i = 0; i < ctx->lookahead; i++)
+            {
+                ctx->fwdBuf[i] = ctx->fwdBuf[ctx->hopSize + i];
+            }
+            ctx->fwdLen = ctx->lookahead;
+            ctx->readyIdx = 0;
+            ctx->ready = 1;
+        }
     }
     return 0;
 }
@@ -146,12 +955,34 @@ pk_quotient_filter_mask_u32(uint32_t *data, uint8_t *mask, uint32_t dataLen, uin
 uint32_t
 pk_smooth_signal_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, float32_t *wBuffer, uint32_t windowSize)
 {
-    // Utilize dot product to compute moving average
+    // Running sum moving average- O(1) per sample regardless of window size
+    if (windowSize == 0 || blockSize <= windowSize)
+    {
+        return 1;
+    }
     uint32_t halfWindowSize = windowSize / 2;
-    arm_fill_f32(1.0f / windowSize, wBuffer, windowSize);
+    float32_t scale = 1.0f / windowSize;
+    float32_t sum = 0;
+    for (size_t i = 0; i < windowSize; i++)
+    {
+        sum += pSrc[i];
+    }
     for (size_t i = 0; i < blockSize - windowSize; i++)
     {
-        arm_dot_prod_f32(pSrc + i, wBuffer, windowSize, pResult + i + halfWindowSize);
+        pResult[i + halfWindowSize] = sum * scale;
+        // Recompute sum once per window to bound accumulated rounding error
+        if ((i + 1) % windowSize == 0)
+        {
+            sum = 0;
+            for (size_t j = i + 1; j <= i + windowSize; j++)
+            {
+                sum += pSrc[j];
+            }
+        }
+        else
+        {
+            sum += pSrc[i + windowSize] - pSrc[i];
+        }
     }
     // Replicate first and last values at the edges
     arm_fill_f32(pResult[halfWindowSize], pResult, halfWindowSize);
@@ -161,6 +992,62 @@ pk_smooth_signal_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, fl
     return 0;
 }
 
+uint32_t
+pk_init_moving_average_f32(moving_avg_f32_t *ctx)
+{
+    if (ctx->windowSize == 0)
+    {
+        return 1;
+    }
+    arm_fill_f32(0, ctx->buffer, ctx->windowSize);
+    ctx->bufIdx = 0;
+    ctx->numSamples = 0;
+    ctx->sum = 0;
+    return 0;
+}
+
+uint32_t
+pk_apply_moving_average_f32(moving_avg_f32_t *ctx, float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
+{
+    uint32_t windowSize = ctx->windowSize;
+    float32_t scale = 1.0f / windowSize;
+    float32_t *buffer = ctx->buffer;
+    uint32_t bufIdx = ctx->bufIdx;
+    uint32_t numSamples = ctx->numSamples;
+    float32_t sum = ctx->sum;
+    float32_t x;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        x = pSrc[i];
+        sum += x - buffer[bufIdx];
+        buffer[bufIdx++] = x;
+        if (bufIdx == windowSize)
+        {
+            bufIdx = 0;
+            // Recompute sum once per window to bound accumulated rounding error
+            sum = 0;
+            for (size_t j = 0; j < windowSize; j++)
+            {
+                sum += buffer[j];
+            }
+        }
+        if (numSamples < windowSize)
+        {
+            // Warm-up: average over samples seen so far
+            numSamples++;
+            pResult[i] = sum / numSamples;
+        }
+        else
+        {
+            pResult[i] = sum * scale;
+        }
+    }
+    ctx->bufIdx = bufIdx;
+    ctx->numSamples = numSamples;
+    ctx->sum = sum;
+    return 0;
+}
+
 uint32_t
 pk_standardize_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, float32_t epsilon)
 {
@@ -168,8 +1055,8 @@ pk_standardize_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize, floa
     pk_mean_f32(pSrc, &mu, blockSize);
     pk_std_f32(pSrc, &std, blockSize);
     std = std + epsilon;
-    arm_offset_f32(pSrc, -mu, pResult, blockSize);
-    arm_scale_f32(pResult, 1.0f / std, pResult, blockSize);
+    pk_dsp_offset_f32(pSrc, -mu, pResult, blockSize);
+    pk_dsp_scale_f32(pResult, 1.0f / std, pResult, blockSize);
     return 0;
 }
 
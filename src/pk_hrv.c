@@ -9,29 +9,109 @@
  *
  */
 #include <math.h>
+#include <string.h>
 #include "arm_math.h"
 
 #include "pk_filter.h"
 #include "pk_hrv.h"
+#include "pk_sort.h"
+
+#define PK_HRV_NUM_PRC (5)
+#define PK_HRV_MAD_SCALE (1.4826f)
+
+static float32_t
+pk_hrv_interp_rank(float32_t *x, float32_t pos)
+{
+    // Linear interpolation between order statistics (assumes both selected)
+    size_t idx = (size_t)pos;
+    float32_t frac = pos - idx;
+    return frac > 0 ? x[idx] + frac*(x[idx + 1] - x[idx]) : x[idx];
+}
+
+static void
+pk_hrv_robust_metrics(float32_t *nn, uint32_t numNN, hrv_td_metrics_t *metrics)
+{
+    // 20th, 25th, 50th, 75th and 80th percentiles (linear interpolation) from one multiselect
+    static const float32_t prcs[PK_HRV_NUM_PRC] = {0.20f, 0.25f, 0.50f, 0.75f, 0.80f};
+    float32_t pos[PK_HRV_NUM_PRC];
+    float32_t vals[PK_HRV_NUM_PRC];
+    size_t ranks[2*PK_HRV_NUM_PRC + 1];
+    size_t numRanks = 0;
+    for (size_t i = 0; i < PK_HRV_NUM_PRC; i++) {
+        pos[i] = prcs[i]*(numNN - 1);
+        size_t lo = (size_t)pos[i];
+        if (numRanks == 0 || ranks[numRanks - 1] < lo) {
+            ranks[numRanks++] = lo;
+        }
+        if (lo + 1 < numNN && ranks[numRanks - 1] < lo + 1) {
+            ranks[numRanks++] = lo + 1;
+        }
+    }
+    pk_multiselect_f32(nn, numNN, ranks, numRanks);
+    for (size_t i = 0; i < PK_HRV_NUM_PRC; i++) {
+        vals[i] = pk_hrv_interp_rank(nn, pos[i]);
+    }
+    metrics->prc20NN = vals[0];
+    metrics->iqrNN = vals[3] - vals[1];
+    metrics->medianNN = vals[2];
+    metrics->prc80NN = vals[4];
+
+    // MAD reuses scratch for absolute deviations
+    for (size_t i = 0; i < numNN; i++) {
+        nn[i] = fabsf(nn[i] - metrics->medianNN);
+    }
+    size_t lo = (size_t)pos[2];
+    numRanks = 0;
+    ranks[numRanks++] = lo;
+    if (lo + 1 < numNN) {
+        ranks[numRanks++] = lo + 1;
+    }
+    pk_multiselect_f32(nn, numNN, ranks, numRanks);
+    metrics->madNN = PK_HRV_MAD_SCALE*pk_hrv_interp_rank(nn, pos[2]);
+    metrics->mcvNN = metrics->madNN/metrics->medianNN;
+}
 
 
 uint32_t
-pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_td_metrics_t *metrics, uint32_t sampleRate) {
+pk_hrv_time_metrics_workspace_size(uint32_t numPeaks) {
+    // Valid NN intervals for in-place selection
+    return numPeaks;
+}
+
+uint32_t
+pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_td_metrics_t *metrics, uint32_t sampleRate, float32_t *scratch) {
     // Deviation-based
     metrics->meanNN = 0;
     metrics->sdNN = 0;
+    metrics->minNN = 0;
+    metrics->maxNN = 0;
     uint32_t numValid = 0;
     float32_t val;
+    float32_t msScale = 1000.0f/sampleRate;
     for (size_t i = 0; i < numPeaks; i++){
         if (mask[i] == 0) {
-            val = 1000.0*rrIntervals[i]/sampleRate;
+            val = msScale*rrIntervals[i];
             metrics->meanNN += val;
             metrics->sdNN += val*val;
+            if (val < metrics->minNN || numValid == 0) {
+                metrics->minNN = val;
+            }
+            if (val > metrics->maxNN || numValid == 0) {
+                metrics->maxNN = val;
+            }
+            if (scratch != NULL) {
+                scratch[numValid] = val;
+            }
             numValid++;
         }
     }
+    if (numValid == 0) {
+        memset(metrics, 0, sizeof(hrv_td_metrics_t));
+        return 1;
+    }
     metrics->meanNN /= numValid;
     metrics->sdNN = sqrt(metrics->sdNN/numValid - metrics->meanNN*metrics->meanNN);
+    uint32_t numNN = numValid;
 
     // Difference-based
     float32_t meanSD = 0;
@@ -39,8 +119,8 @@ pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t nu
     metrics->sdSD = 0;
     metrics->nn20 = 0;
     metrics->nn50 = 0;
-    metrics->minNN = -1;
-    metrics->maxNN = -1;
+    metrics->pnn20 = 0;
+    metrics->pnn50 = 0;
     float32_t v1, v2, v3, v4, v5;
     numValid = 0;
     for (size_t i = 1; i < numPeaks; i++)
@@ -49,8 +129,8 @@ pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t nu
             continue;
         }
         numValid++;
-        v1 = 1000.0*rrIntervals[i - 1]/(float32_t)sampleRate;
-        v2 = 1000.0*rrIntervals[i]/(float32_t)sampleRate;
+        v1 = msScale*rrIntervals[i - 1];
+        v2 = msScale*rrIntervals[i];
         v3 = (v2 - v1);
         v4 = v3*v3;
         v5 = fabsf(v3);
@@ -63,14 +143,8 @@ pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t nu
         if (v5 > 50) {
             metrics->nn50++;
         }
-        if (rrIntervals[i] < metrics->minNN || metrics->minNN == -1) {
-            metrics->minNN = rrIntervals[i];
-        }
-        if (rrIntervals[i] > metrics->maxNN || metrics->maxNN == -1) {
-            metrics->maxNN = rrIntervals[i];
-        }
     }
-    if (numValid > 1) {
+    if (numValid > 0) {
         meanSD /= numValid;
         metrics->rmsSD = sqrtf(metrics->rmsSD/numValid);
         metrics->sdSD = sqrtf(metrics->sdSD/numValid - meanSD*meanSD);
@@ -82,19 +156,302 @@ pk_hrv_compute_time_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t nu
     metrics->cvSD = metrics->rmsSD/metrics->meanNN;
 
     // Robust
-    metrics->medianNN = 0;
-    metrics->madNN = 0;
-    metrics->mcvNN = 0;
-    // Use mean & std for IQR
-    float32_t q1 = metrics->meanNN - 0.6745*metrics->sdNN;
-    float32_t q3 = metrics->meanNN + 0.6745*metrics->sdNN;
-    metrics->iqrNN = q3 - q1;
-    metrics->prc20NN = 0;
-    metrics->prc80NN = 0;
+    if (scratch != NULL) {
+        pk_hrv_robust_metrics(scratch, numNN, metrics);
+    } else {
+        metrics->medianNN = 0;
+        metrics->madNN = 0;
+        metrics->mcvNN = 0;
+        metrics->iqrNN = 0;
+        metrics->prc20NN = 0;
+        metrics->prc80NN = 0;
+    }
+    return 0;
+}
+
+#define PK_HRV_MASKED (0x80000000UL)
+
+static void
+pk_hrv_stream_evict(hrv_td_stream_t *ctx)
+{
+    uint32_t seq = ctx->head;
+    uint32_t val = ctx->rri[seq % ctx->capacity];
+    uint32_t rr = val & ~PK_HRV_MASKED;
+    if (!(val & PK_HRV_MASKED)) {
+        ctx->numNN--;
+        ctx->sumNN -= rr;
+        ctx->sumSqNN -= (uint64_t)rr*rr;
+        if (ctx->minHead != ctx->minTail && ctx->minQ[ctx->minHead % ctx->capacity] == seq) {
+            ctx->minHead++;
+        }
+        if (ctx->maxHead != ctx->maxTail && ctx->maxQ[ctx->maxHead % ctx->capacity] == seq) {
+            ctx->maxHead++;
+        }
+        // Remove successive difference with next beat
+        if (seq + 1 != ctx->tail) {
+            uint32_t next = ctx->rri[(seq + 1) % ctx->capacity];
+            if (!(next & PK_HRV_MASKED)) {
+                int64_t d = (int64_t)next - (int64_t)rr;
+                uint64_t ad = d < 0 ? -d : d;
+                ctx->numSD--;
+                ctx->sumSD -= d;
+                ctx->sumSqSD -= ad*ad;
+                ctx->nn20 -= ad*1000 > 20ULL*ctx->sampleRate ? 1 : 0;
+                ctx->nn50 -= ad*1000 > 50ULL*ctx->sampleRate ? 1 : 0;
+            }
+        }
+    }
+    ctx->sumTicks -= rr;
+    ctx->head++;
+}
+
+uint32_t
+pk_hrv_init_stream(hrv_td_stream_t *ctx) {
+    if (ctx->capacity == 0) {
+        return 1;
+    }
+    ctx->rri = &ctx->state[0];
+    ctx->minQ = &ctx->state[ctx->capacity];
+    ctx->maxQ = &ctx->state[2*ctx->capacity];
+    ctx->head = 0;
+    ctx->tail = 0;
+    ctx->minHead = 0;
+    ctx->minTail = 0;
+    ctx->maxHead = 0;
+    ctx->maxTail = 0;
+    ctx->windowTicks = (uint64_t)(ctx->windowLen*ctx->sampleRate);
+    ctx->sumTicks = 0;
+    ctx->numNN = 0;
+    ctx->sumNN = 0;
+    ctx->sumSqNN = 0;
+    ctx->numSD = 0;
+    ctx->sumSD = 0;
+    ctx->sumSqSD = 0;
+    ctx->nn20 = 0;
+    ctx->nn50 = 0;
+    return 0;
+}
+
+uint32_t
+pk_hrv_stream_push_rr_interval(hrv_td_stream_t *ctx, uint32_t rrInterval, uint8_t mask) {
+    uint32_t rr = rrInterval & ~PK_HRV_MASKED;
+    uint32_t seq = ctx->tail;
+    if (ctx->tail - ctx->head == ctx->capacity) {
+        pk_hrv_stream_evict(ctx);
+    }
+    ctx->rri[seq % ctx->capacity] = mask ? rr | PK_HRV_MASKED : rr;
+    ctx->tail++;
+    ctx->sumTicks += rr;
+    if (!mask) {
+        ctx->numNN++;
+        ctx->sumNN += rr;
+        ctx->sumSqNN += (uint64_t)rr*rr;
+        // Maintain monotonic deques (values increasing for min, decreasing for max)
+        while (ctx->minTail != ctx->minHead && (ctx->rri[ctx->minQ[(ctx->minTail - 1) % ctx->capacity] % ctx->capacity] & ~PK_HRV_MASKED) >= rr) {
+            ctx->minTail--;
+        }
+        ctx->minQ[ctx->minTail++ % ctx->capacity] = seq;
+        while (ctx->maxTail != ctx->maxHead && (ctx->rri[ctx->maxQ[(ctx->maxTail - 1) % ctx->capacity] % ctx->capacity] & ~PK_HRV_MASKED) <= rr) {
+            ctx->maxTail--;
+        }
+        ctx->maxQ[ctx->maxTail++ % ctx->capacity] = seq;
+        // Add successive difference with previous beat
+        if (seq != ctx->head) {
+            uint32_t prev = ctx->rri[(seq - 1) % ctx->capacity];
+            if (!(prev & PK_HRV_MASKED)) {
+                int64_t d = (int64_t)rr - (int64_t)prev;
+                uint64_t ad = d < 0 ? -d : d;
+                ctx->numSD++;
+                ctx->sumSD += d;
+                ctx->sumSqSD += ad*ad;
+                ctx->nn20 += ad*1000 > 20ULL*ctx->sampleRate ? 1 : 0;
+                ctx->nn50 += ad*1000 > 50ULL*ctx->sampleRate ? 1 : 0;
+            }
+        }
+    }
+    // Evict beats that fall outside of window
+    while (ctx->sumTicks > ctx->windowTicks && ctx->tail - ctx->head > 1) {
+        pk_hrv_stream_evict(ctx);
+    }
     return 0;
 }
 
 uint32_t
-pk_hrv_compute_freq_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_fd_metrics_t *metrics){
-    return 1;
+pk_hrv_stream_get_time_metrics(hrv_td_stream_t *ctx, hrv_td_metrics_t *metrics) {
+    memset(metrics, 0, sizeof(hrv_td_metrics_t));
+    if (ctx->numNN == 0) {
+        return 1;
+    }
+    // Convert integer tick moments to ms only on read
+    float32_t msScale = 1000.0f/ctx->sampleRate;
+    float64_t n = ctx->numNN;
+    float64_t varNN = ((float64_t)ctx->sumSqNN*n - (float64_t)ctx->sumNN*ctx->sumNN)/(n*n);
+    metrics->meanNN = msScale*(float32_t)(ctx->sumNN/n);
+    metrics->sdNN = msScale*sqrtf((float32_t)(varNN > 0 ? varNN : 0));
+    if (ctx->numSD > 0) {
+        float64_t m = ctx->numSD;
+        float64_t meanSD = ctx->sumSD/m;
+        float64_t varSD = ctx->sumSqSD/m - meanSD*meanSD;
+        metrics->rmsSD = msScale*sqrtf((float32_t)(ctx->sumSqSD/m));
+        metrics->sdSD = msScale*sqrtf((float32_t)(varSD > 0 ? varSD : 0));
+        metrics->nn20 = ctx->nn20;
+        metrics->nn50 = ctx->nn50;
+        metrics->pnn20 = 100.0f*ctx->nn20/ctx->numSD;
+        metrics->pnn50 = 100.0f*ctx->nn50/ctx->numSD;
+    }
+    metrics->cvNN = metrics->sdNN/metrics->meanNN;
+    metrics->cvSD = metrics->rmsSD/metrics->meanNN;
+    metrics->minNN = msScale*(ctx->rri[ctx->minQ[ctx->minHead % ctx->capacity] % ctx->capacity] & ~PK_HRV_MASKED);
+    metrics->maxNN = msScale*(ctx->rri[ctx->maxQ[ctx->maxHead % ctx->capacity] % ctx->capacity] & ~PK_HRV_MASKED);
+    return 0;
+}
+
+#define PK_HRV_VLF_LO (0.0033f)
+#define PK_HRV_VLF_HI (0.04f)
+#define PK_HRV_LF_HI (0.15f)
+#define PK_HRV_HF_HI (0.4f)
+#define PK_HRV_LS_GRID_OVERSAMPLE (8) // Grid points per period at highest frequency
+#define PK_HRV_LS_MAX_FFT_LEN (4096)
+
+static uint32_t
+pk_hrv_ls_fft_len(float32_t freqRes)
+{
+    if (freqRes <= 0) {
+        return 0;
+    }
+    uint32_t numFreqs = (uint32_t)(PK_HRV_HF_HI/freqRes);
+    uint32_t fftLen = 32;
+    while (fftLen < PK_HRV_LS_GRID_OVERSAMPLE*numFreqs) {
+        fftLen <<= 1;
+    }
+    return fftLen <= PK_HRV_LS_MAX_FFT_LEN ? fftLen : 0;
+}
+
+static void
+pk_hrv_extirpolate(float32_t *grid, uint32_t gridLen, float32_t pos, float32_t val)
+{
+    // Spread val onto 4 nearest grid points (periodic) with cubic Lagrange weights
+    uint32_t idx = (uint32_t)pos;
+    float32_t u = pos - idx;
+    uint32_t mask = gridLen - 1;
+    grid[(idx - 1) & mask] -= val*u*(u - 1)*(u - 2)/6.0f;
+    grid[idx & mask] += val*(u + 1)*(u - 1)*(u - 2)/2.0f;
+    grid[(idx + 1) & mask] -= val*(u + 1)*u*(u - 2)/2.0f;
+    grid[(idx + 2) & mask] += val*(u + 1)*u*(u - 1)/6.0f;
+}
+
+uint32_t
+pk_hrv_freq_metrics_workspace_size(float32_t freqRes)
+{
+    // Two extirpolation grids + FFT output
+    return 3*pk_hrv_ls_fft_len(freqRes);
+}
+
+uint32_t
+pk_hrv_compute_freq_metrics_from_rr_intervals(uint32_t *rrIntervals, uint32_t numPeaks, uint8_t *mask, hrv_fd_metrics_t *metrics, uint32_t sampleRate, float32_t freqRes, float32_t *workspace){
+    memset(metrics, 0, sizeof(hrv_fd_metrics_t));
+    uint32_t fftLen = pk_hrv_ls_fft_len(freqRes);
+    if (fftLen == 0) {
+        return 1;
+    }
+    float32_t *ySpec = &workspace[0];
+    float32_t *wSpec = &workspace[fftLen];
+    float32_t *grid = &workspace[2*fftLen];
+
+    // Mean NN and time span of valid beats
+    float32_t msScale = 1000.0f/sampleRate;
+    uint32_t numValid = 0;
+    uint64_t meanTicks = 0;
+    uint64_t tick = 0, tickStart = 0, tickEnd = 0;
+    for (size_t i = 0; i < numPeaks; i++) {
+        tick += rrIntervals[i];
+        if (mask[i] == 0) {
+            if (numValid == 0) {
+                tickStart = tick;
+            }
+            tickEnd = tick;
+            meanTicks += rrIntervals[i];
+            numValid++;
+        }
+    }
+    float32_t duration = (float32_t)(tickEnd - tickStart)/sampleRate;
+    if (numValid < 4 || duration*freqRes > 1.0f) {
+        return 1;
+    }
+    float32_t meanNN = msScale*meanTicks/numValid;
+
+    // Extirpolate mean-removed NN at t and unit weights at 2t onto grid
+    // (grid index = t*fftLen*freqRes so FFT bin k is frequency k*freqRes)
+    float32_t gridScale = fftLen*freqRes/sampleRate;
+    arm_rfft_fast_instance_f32 fftCtx;
+    arm_rfft_fast_init_f32(&fftCtx, fftLen);
+    memset(grid, 0, fftLen*sizeof(float32_t));
+    tick = 0;
+    for (size_t i = 0; i < numPeaks; i++) {
+        tick += rrIntervals[i];
+        if (mask[i] == 0) {
+            pk_hrv_extirpolate(grid, fftLen, gridScale*(tick - tickStart), msScale*rrIntervals[i] - meanNN);
+        }
+    }
+    arm_rfft_fast_f32(&fftCtx, grid, ySpec, 0);
+    memset(grid, 0, fftLen*sizeof(float32_t));
+    tick = 0;
+    for (size_t i = 0; i < numPeaks; i++) {
+        tick += rrIntervals[i];
+        if (mask[i] == 0) {
+            pk_hrv_extirpolate(grid, fftLen, fmodf(2*gridScale*(tick - tickStart), fftLen), 1.0f);
+        }
+    }
+    arm_rfft_fast_f32(&fftCtx, grid, wSpec, 0);
+
+    // Grid is free- reuse for frequency bins
+    float32_t *freqs = grid;
+    pk_compute_frequency_bins(freqs, fftLen*freqRes, fftLen);
+
+    // One-sided PSD (ms^2/Hz) integrated over bins of width freqRes
+    float32_t powerScale = 2.0f*duration*freqRes/(numValid - 1);
+    float32_t vlfMax = 0, lfMax = 0, hfMax = 0;
+    float32_t yr, yi, wr, wi, hypo, hc2wt, hs2wt, cwt, swt, den, cterm, sterm, power;
+    for (size_t k = 1; k < fftLen/2 && freqs[k] <= PK_HRV_HF_HI; k++) {
+        if (freqs[k] < PK_HRV_VLF_LO) {
+            continue;
+        }
+        yr = ySpec[2*k];
+        yi = ySpec[2*k + 1];
+        wr = wSpec[2*k];
+        wi = wSpec[2*k + 1];
+        // Lomb-Scargle with time offset tau: tan(2*w*tau) = wi/wr
+        hypo = sqrtf(wr*wr + wi*wi);
+        hc2wt = hypo > 0 ? 0.5f*wr/hypo : 0.5f;
+        hs2wt = hypo > 0 ? 0.5f*wi/hypo : 0;
+        cwt = sqrtf(0.5f + hc2wt);
+        swt = sqrtf(fmaxf(0.5f - hc2wt, 0));
+        swt = hs2wt < 0 ? -swt : swt;
+        den = 0.5f*numValid + hc2wt*wr + hs2wt*wi;
+        cterm = (cwt*yr + swt*yi)*(cwt*yr + swt*yi)/den;
+        sterm = (cwt*yi - swt*yr)*(cwt*yi - swt*yr)/(numValid - den);
+        power = 0.5f*(cterm + sterm)*powerScale;
+        if (freqs[k] < PK_HRV_VLF_HI) {
+            metrics->vlfPower += power;
+            if (power > vlfMax) {
+                vlfMax = power;
+                metrics->vlfPeak = freqs[k];
+            }
+        } else if (freqs[k] < PK_HRV_LF_HI) {
+            metrics->lfPower += power;
+            if (power > lfMax) {
+                lfMax = power;
+                metrics->lfPeak = freqs[k];
+            }
+        } else {
+            metrics->hfPower += power;
+            if (power > hfMax) {
+                hfMax = power;
+                metrics->hfPeak = freqs[k];
+            }
+        }
+    }
+    metrics->totalPower = metrics->vlfPower + metrics->lfPower + metrics->hfPower;
+    metrics->lfhfRatio = metrics->hfPower > 0 ? metrics->lfPower/metrics->hfPower : 0;
+    return 0;
 }
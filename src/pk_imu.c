@@ -8,17 +8,61 @@
  * @copyright Copyright (c) 2023
  *
  */
+#include <math.h>
+#include <string.h>
 #include "arm_math.h"
 
+#include "pk_math.h"
 #include "pk_imu.h"
 
+// Odd minimax polynomial for atan(a), a in [0, 1]
+#define PK_IMU_ATAN_C1 (0.99997726f)
+#define PK_IMU_ATAN_C3 (-0.33262347f)
+#define PK_IMU_ATAN_C5 (0.19354346f)
+#define PK_IMU_ATAN_C7 (-0.11643287f)
+#define PK_IMU_ATAN_C9 (0.05265332f)
+#define PK_IMU_ATAN_C11 (-0.01172120f)
+
+#define PK_IMU_BLOCK (8) // Samples per vectorized block in fast mode
+
+static inline float32_t
+pk_imu_fast_atan2_f32(float32_t y, float32_t x)
+{
+    // Reduce to [0, 1] with min/max ratio then fix up octant with selects
+    float32_t ax = fabsf(x), ay = fabsf(y);
+    float32_t mx = ax > ay ? ax : ay;
+    float32_t mn = ax > ay ? ay : ax;
+    // mn is 0 whenever mx is, so dividing by 1 keeps the select off the divide
+    float32_t a = mn / (mx > 0 ? mx : 1.0f);
+    float32_t s = a * a;
+    float32_t r = a * (PK_IMU_ATAN_C1 + s * (PK_IMU_ATAN_C3 + s * (PK_IMU_ATAN_C5 + s * (PK_IMU_ATAN_C7 + s * (PK_IMU_ATAN_C9 + s * PK_IMU_ATAN_C11)))));
+    r = ay > ax ? PI / 2 - r : r;
+    r = signbit(x) ? PI - r : r;
+    return copysignf(r, y);
+}
+
+static inline float32_t
+pk_imu_fast_sqrt_f32(float32_t v)
+{
+    // sqrt(v) = v * rsqrt(v), rsqrt from bit estimate + 2 Newton steps (v = 0 gives 0)
+    uint32_t i;
+    float32_t r;
+    memcpy(&i, &v, sizeof(i));
+    i = 0x5F375A86U - (i >> 1);
+    memcpy(&r, &i, sizeof(r));
+    r = r * (1.5f - 0.5f * v * r * r);
+    r = r * (1.5f - 0.5f * v * r * r);
+    return v * r;
+}
+
 uint32_t
 pk_imu_compute_enmo_f32(float32_t *x, float32_t *y, float32_t *z, float32_t *enmo, uint32_t blockSize)
 {
     // enmo = np.maximum(np.sqrt(x**2 + y**2 + z**2) - 1, 0)
     for (size_t i = 0; i < blockSize; i++)
     {
-        enmo[i] = sqrtf(powf(x[i], 2) + powf(y[i], 2) + powf(z[i], 2) - 1.0f);
+        float32_t norm = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        enmo[i] = norm > 1.0f ? norm - 1.0f : 0;
     }
     return 0;
 }
@@ -31,9 +75,10 @@ pk_imu_compute_tilt_angles_f32(float32_t *x, float32_t *y, float32_t *z, float32
     // zAngle = np.arctan2(z, np.sqrt(x**2 + y**2))
     for (size_t i = 0; i < blockSize; i++)
     {
-        xAngle[i] = atan2f(x[i], sqrtf(powf(y[i], 2) + powf(z[i], 2)));
-        yAngle[i] = atan2f(y[i], sqrtf(powf(x[i], 2) + powf(z[i], 2)));
-        zAngle[i] = atan2f(z[i], sqrtf(powf(x[i], 2) + powf(y[i], 2)));
+        float32_t xx = x[i] * x[i], yy = y[i] * y[i], zz = z[i] * z[i];
+        xAngle[i] = atan2f(x[i], sqrtf(yy + zz));
+        yAngle[i] = atan2f(y[i], sqrtf(xx + zz));
+        zAngle[i] = atan2f(z[i], sqrtf(xx + yy));
     }
     return 0;
 }
@@ -45,8 +90,150 @@ pk_imu_compute_pitch_roll_f32(float32_t *x, float32_t *y, float32_t *z, float32_
     // roll = np.arctan2(y, z)
     for (size_t i = 0; i < blockSize; i++)
     {
-        pitch[i] = atan2f(-x[i], sqrtf(powf(y[i], 2) + powf(z[i], 2)));
+        pitch[i] = atan2f(-x[i], sqrtf(y[i] * y[i] + z[i] * z[i]));
         roll[i] = atan2f(y[i], z[i]);
     }
     return 0;
 }
+
+static inline void
+pk_imu_features_f32(const float32_t *restrict x, const float32_t *restrict y, const float32_t *restrict z, float32_t *restrict enmo, float32_t *restrict xAngle, float32_t *restrict yAngle, float32_t *restrict zAngle, float32_t *restrict pitch, float32_t *restrict roll, uint32_t blockSize, const uint32_t fast)
+{
+    // fast is a literal at each call site so both variants are specialized
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        float32_t xi = x[i], yi = y[i], zi = z[i];
+        float32_t xx = xi * xi, yy = yi * yi, zz = zi * zi;
+        float32_t norm = fast ? pk_imu_fast_sqrt_f32(xx + yy + zz) : sqrtf(xx + yy + zz);
+        float32_t ryz = fast ? pk_imu_fast_sqrt_f32(yy + zz) : sqrtf(yy + zz);
+        float32_t rxz = fast ? pk_imu_fast_sqrt_f32(xx + zz) : sqrtf(xx + zz);
+        float32_t rxy = fast ? pk_imu_fast_sqrt_f32(xx + yy) : sqrtf(xx + yy);
+        float32_t xa = fast ? pk_imu_fast_atan2_f32(xi, ryz) : atan2f(xi, ryz);
+        enmo[i] = norm > 1.0f ? norm - 1.0f : 0;
+        xAngle[i] = xa;
+        yAngle[i] = fast ? pk_imu_fast_atan2_f32(yi, rxz) : atan2f(yi, rxz);
+        zAngle[i] = fast ? pk_imu_fast_atan2_f32(zi, rxy) : atan2f(zi, rxy);
+        // atan2 is odd in its first argument
+        pitch[i] = -xa;
+        roll[i] = fast ? pk_imu_fast_atan2_f32(yi, zi) : atan2f(yi, zi);
+    }
+}
+
+uint32_t
+pk_imu_compute_features_f32(float32_t *x, float32_t *y, float32_t *z, imu_features_f32_t *features, uint32_t blockSize, uint32_t mathMode)
+{
+    imu_features_f32_t *f = features;
+    if (!f->enmo || !f->xAngle || !f->yAngle || !f->zAngle || !f->pitch || !f->roll || mathMode > PK_IMU_MATH_FAST)
+    {
+        return 1;
+    }
+    if (mathMode == PK_IMU_MATH_FAST)
+    {
+        // Fixed length blocks let the compiler vectorize without a scalar epilogue
+        size_t i = 0;
+        for (; i + PK_IMU_BLOCK <= blockSize; i += PK_IMU_BLOCK)
+        {
+            pk_imu_features_f32(&x[i], &y[i], &z[i], &f->enmo[i], &f->xAngle[i], &f->yAngle[i], &f->zAngle[i], &f->pitch[i], &f->roll[i], PK_IMU_BLOCK, 1);
+        }
+        pk_imu_features_f32(&x[i], &y[i], &z[i], &f->enmo[i], &f->xAngle[i], &f->yAngle[i], &f->zAngle[i], &f->pitch[i], &f->roll[i], blockSize - i, 1);
+    }
+    else
+    {
+        pk_imu_features_f32(x, y, z, f->enmo, f->xAngle, f->yAngle, f->zAngle, f->pitch, f->roll, blockSize, 0);
+    }
+    return 0;
+}
+
+uint32_t
+pk_imu_activity_state_size_f32(imu_activity_f32_t *ctx)
+{
+    return (uint32_t)(ctx->epochLen * ctx->sampleRate + 0.5f);
+}
+
+uint32_t
+pk_imu_init_activity_f32(imu_activity_f32_t *ctx)
+{
+    ctx->epochSamples = pk_imu_activity_state_size_f32(ctx);
+    ctx->stillSamples = (uint32_t)(ctx->stillWin * ctx->sampleRate + 0.5f);
+    if (ctx->epochSamples == 0 || ctx->stillSamples == 0 || ctx->numThresholds > PK_IMU_MAX_THRESHOLDS || ctx->state == NULL)
+    {
+        return 1;
+    }
+    ctx->numSamples = 0;
+    ctx->epochIdx = 0;
+    ctx->sumEnmo = 0;
+    memset(ctx->counts, 0, sizeof(ctx->counts));
+    ctx->stillLen = 0;
+    ctx->stillSum = 0;
+    ctx->stillSumSq = 0;
+    ctx->numStill = 0;
+    ctx->numWins = 0;
+    return 0;
+}
+
+static void
+pk_imu_activity_emit_f32(imu_activity_f32_t *ctx, imu_activity_epoch_t *epoch)
+{
+    // MAD needs the epoch mean first, so magnitudes are held for one epoch
+    float32_t *mag = ctx->state;
+    float32_t n = (float32_t)ctx->epochSamples;
+    float32_t mean, mad = 0;
+    pk_mean_f32(mag, &mean, ctx->epochSamples);
+    for (size_t i = 0; i < ctx->epochSamples; i++)
+    {
+        mad += fabsf(mag[i] - mean);
+    }
+    memset(epoch, 0, sizeof(*epoch));
+    epoch->epochIdx = ctx->epochIdx;
+    epoch->meanEnmo = ctx->sumEnmo / n;
+    epoch->mad = mad / n;
+    memcpy(epoch->counts, ctx->counts, ctx->numThresholds * sizeof(uint32_t));
+    epoch->stillPct = ctx->numWins > 0 ? 100.0f * ctx->numStill / ctx->numWins : 0;
+
+    ctx->epochIdx++;
+    ctx->numSamples = 0;
+    ctx->sumEnmo = 0;
+    memset(ctx->counts, 0, sizeof(ctx->counts));
+    ctx->stillLen = 0;
+    ctx->stillSum = 0;
+    ctx->stillSumSq = 0;
+    ctx->numStill = 0;
+    ctx->numWins = 0;
+}
+
+uint32_t
+pk_imu_activity_push_f32(imu_activity_f32_t *ctx, float32_t *x, float32_t *y, float32_t *z, uint32_t blockSize, imu_activity_epoch_t *epochs)
+{
+    float32_t *mag = ctx->state;
+    uint32_t numEpochs = 0;
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        float32_t norm = sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        float32_t enmo = norm > 1.0f ? norm - 1.0f : 0;
+        mag[ctx->numSamples++] = norm;
+        ctx->sumEnmo += enmo;
+        for (size_t t = 0; t < ctx->numThresholds; t++)
+        {
+            ctx->counts[t] += enmo > ctx->thresholds[t];
+        }
+        // Accumulate about 1 g to limit cancellation in the variance
+        float32_t d = norm - 1.0f;
+        ctx->stillSum += d;
+        ctx->stillSumSq += d * d;
+        if (++ctx->stillLen == ctx->stillSamples)
+        {
+            float32_t mean = ctx->stillSum / ctx->stillLen;
+            float32_t var = ctx->stillSumSq / ctx->stillLen - mean * mean;
+            ctx->numStill += var < ctx->stillThresh * ctx->stillThresh;
+            ctx->numWins++;
+            ctx->stillLen = 0;
+            ctx->stillSum = 0;
+            ctx->stillSumSq = 0;
+        }
+        if (ctx->numSamples == ctx->epochSamples)
+        {
+            pk_imu_activity_emit_f32(ctx, &epochs[numEpochs++]);
+        }
+    }
+    return numEpochs;
+}
@@ -15,20 +15,127 @@
 #include "pk_interpolation.h"
 
 
+static inline size_t
+pk_interp_segment(float32_t *x, uint32_t xLen, float32_t xq, float32_t xPrev, size_t j)
+{
+    // Right knot of segment holding xq, clamped to [1, xLen - 1] so the end
+    // segments extrapolate. Walk forward from last segment while queries
+    // increase, otherwise restart with binary search.
+    if (xq < xPrev)
+    {
+        j = pk_binary_search_f32(x, xLen, xq);
+        j = (j == 0) ? 1 : j;
+    }
+    while (j < xLen - 1 && x[j] < xq)
+    {
+        j++;
+    }
+    return j;
+}
+
 void
 pk_inter1d_f32(float32_t *x, float32_t *y, uint32_t xLen, float32_t *xNew, float32_t *yNew, uint32_t xNewLen)
 {
+    if (xLen < 2)
+    {
+        for (size_t i = 0; i < xNewLen; i++)
+        {
+            yNew[i] = xLen == 1 ? y[0] : 0;
+        }
+        return;
+    }
+    size_t j = 1;
+    size_t seg = 0; // Segment of cached slope (0 = none)
+    float32_t slope = 0;
+    float32_t xPrev = xNewLen > 0 ? xNew[0] : 0;
     for (size_t i = 0; i < xNewLen; i++)
     {
-        // Find the two known x values using binary search.
-        size_t j = pk_binary_search_f32(x, xLen, xNew[i]);
+        j = pk_interp_segment(x, xLen, xNew[i], xPrev, j);
+        xPrev = xNew[i];
+        if (j != seg)
+        {
+            slope = (y[j] - y[j - 1]) / (x[j] - x[j - 1]);
+            seg = j;
+        }
+        yNew[i] = y[j - 1] + slope * (xNew[i] - x[j - 1]);
+    }
+}
 
-        // Handle edge cases.
-        j = (j == 0) ? 1 : (j == xLen) ? xLen - 1 : j;
+uint32_t
+pk_spline_state_size_f32(spline_f32_t *ctx)
+{
+    return 3 * ctx->xLen;
+}
 
-        // Use these two known x values to interpolate the new y value.
-        float32_t slope = (y[j] - y[j - 1]) / (x[j] - x[j - 1]);
-        yNew[i] = y[j - 1] + slope * (xNew[i] - x[j - 1]);
+uint32_t
+pk_init_spline_f32(spline_f32_t *ctx)
+{
+    uint32_t n = ctx->xLen;
+    float32_t *x = ctx->x;
+    float32_t *y = ctx->y;
+    if (n < 2)
+    {
+        return 1;
+    }
+    ctx->b = &ctx->state[0];
+    ctx->c = &ctx->state[n];
+    ctx->d = &ctx->state[2 * n];
+    float32_t *b = ctx->b, *c = ctx->c, *d = ctx->d;
+
+    // Thomas algorithm for curvatures M (natural: M[0] = M[n-1] = 0).
+    // d holds the reduced super diagonal, c the reduced rhs and then M.
+    float32_t h0, h1, diag;
+    d[0] = 0;
+    c[0] = 0;
+    for (size_t i = 1; i < n - 1; i++)
+    {
+        h0 = x[i] - x[i - 1];
+        h1 = x[i + 1] - x[i];
+        diag = 2 * (h0 + h1) - h0 * d[i - 1];
+        d[i] = h1 / diag;
+        c[i] = (6 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0) - h0 * c[i - 1]) / diag;
+    }
+    c[n - 1] = 0;
+    for (size_t i = n - 1; i-- > 1;)
+    {
+        c[i] -= d[i] * c[i + 1];
+    }
+
+    // Segment i: y[i] + t*(b[i] + t*(c[i] + t*d[i])), t = xNew - x[i]
+    float32_t m0, m1;
+    for (size_t i = 0; i < n - 1; i++)
+    {
+        h1 = x[i + 1] - x[i];
+        m0 = c[i];
+        m1 = c[i + 1];
+        b[i] = (y[i + 1] - y[i]) / h1 - h1 * (2 * m0 + m1) / 6;
+        d[i] = (m1 - m0) / (6 * h1);
+        c[i] = m0 / 2;
     }
+    b[n - 1] = 0;
+    c[n - 1] = 0;
+    d[n - 1] = 0;
+    return 0;
+}
 
+uint32_t
+pk_spline_eval_f32(spline_f32_t *ctx, float32_t *xNew, float32_t *yNew, uint32_t xNewLen)
+{
+    float32_t *x = ctx->x;
+    size_t j = 1, k;
+    float32_t t;
+    float32_t xPrev = xNewLen > 0 ? xNew[0] : 0;
+    if (ctx->xLen < 2)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < xNewLen; i++)
+    {
+        j = pk_interp_segment(x, ctx->xLen, xNew[i], xPrev, j);
+        xPrev = xNew[i];
+        k = j - 1;
+        t = xNew[i] - x[k];
+        yNew[i] = ctx->y[k] + t * (ctx->b[k] + t * (ctx->c[k] + t * ctx->d[k]));
+    }
+    return 0;
 }
@@ -11,19 +11,21 @@
 #include <math.h>
 #include "arm_math.h"
 
+#include "pk_dsp.h"
 #include "pk_math.h"
 
 uint32_t
 pk_mean_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
 {
-    arm_mean_f32(pSrc, blockSize, pResult);
+    pk_dsp_mean_f32(pSrc, blockSize, pResult);
     return 0;
 }
 
 uint32_t
 pk_std_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
 {
-    arm_std_f32(pSrc, blockSize, pResult);
+    pk_dsp_var_f32(pSrc, blockSize, pResult);
+    *pResult = sqrtf(*pResult);
     return 0;
 }
 
@@ -43,7 +45,7 @@ pk_gradient_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
 uint32_t
 pk_rms_f32(float32_t *pSrc, float32_t *pResult, uint32_t blockSize)
 {
-    arm_rms_f32(pSrc, blockSize, pResult);
+    pk_dsp_rms_f32(pSrc, blockSize, pResult);
     return 0;
 }
 
@@ -66,9 +68,9 @@ cosine_similarity_f32(
     float32_t *result)
 {
     float32_t dot = 0.0f, normA = 0.0f, normB = 0.0f;
-    arm_dot_prod_f32(ref, sig, len, &dot);
-    arm_dot_prod_f32(ref, ref, len, &normA);
-    arm_dot_prod_f32(sig, sig, len, &normB);
+    pk_dsp_dot_prod_f32(ref, sig, len, &dot);
+    pk_dsp_dot_prod_f32(ref, ref, len, &normA);
+    pk_dsp_dot_prod_f32(sig, sig, len, &normB);
     *result = dot / (sqrtf(normA) * sqrtf(normB));
     return 0;
 }
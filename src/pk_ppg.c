@@ -11,10 +11,18 @@
 #include <math.h>
 #include "arm_math.h"
 
+#include "pk_dsp.h"
 #include "pk_math.h"
 #include "pk_filter.h"
 #include "pk_ppg.h"
 
+uint32_t
+pk_ppg_peak_state_size_f32(ppg_peak_f32_t *ctx, uint32_t ppgLen)
+{
+    // Peak and beat moving averages and squared signal
+    return 3 * ppgLen;
+}
+
 uint32_t
 pk_ppg_find_peaks_f32(ppg_peak_f32_t *ctx, float32_t *ppg, uint32_t ppgLen, uint32_t *peaks)
 {
@@ -30,7 +38,6 @@ pk_ppg_find_peaks_f32(ppg_peak_f32_t *ctx, float32_t *ppg, uint32_t ppgLen, uint
     float32_t *maPeak = &ctx->state[0 * ppgLen];
     float32_t *maBeat = &ctx->state[1 * ppgLen];
     float32_t *sqrd = &ctx->state[2 * ppgLen];
-    float32_t *wBuffer = &ctx->state[3 * ppgLen];
 
     // Compute squared signal
     for (size_t i = 0; i < ppgLen; i++)
@@ -41,14 +48,15 @@ pk_ppg_find_peaks_f32(ppg_peak_f32_t *ctx, float32_t *ppg, uint32_t ppgLen, uint
     pk_mean_f32(sqrd, &muSqrd, ppgLen);
     muSqrd = muSqrd * ctx->beatOffset;
 
-    // Apply peak moving average
-    pk_smooth_signal_f32(sqrd, maPeak, ppgLen, wBuffer, maPeakLen);
-
-    // Apply beat moving average
-    pk_smooth_signal_f32(sqrd, maBeat, ppgLen, wBuffer, maBeatLen);
-    arm_offset_f32(maBeat, muSqrd, maBeat, ppgLen);
+    // Apply peak and beat moving averages (signal shorter than a window has no peaks)
+    if (pk_smooth_signal_f32(sqrd, maPeak, ppgLen, NULL, maPeakLen) != 0 ||
+        pk_smooth_signal_f32(sqrd, maBeat, ppgLen, NULL, maBeatLen) != 0)
+    {
+        return 0;
+    }
+    pk_dsp_offset_f32(maBeat, muSqrd, maBeat, ppgLen);
 
-    arm_sub_f32(maPeak, maBeat, maPeak, ppgLen);
+    pk_dsp_sub_f32(maPeak, maBeat, maPeak, ppgLen);
 
     uint32_t riseEdge, fallEdge, peakDelay, peakLen, peak;
     float32_t peakVal;
@@ -70,7 +78,7 @@ pk_ppg_find_peaks_f32(ppg_peak_f32_t *ctx, float32_t *ppg, uint32_t ppgLen, uint
         if (m != -1 && n != -1)
         {
             peakLen = n - m + 1;
-            arm_max_f32(&sqrd[m], peakLen, &peakVal, &peak);
+            pk_dsp_max_f32(&sqrd[m], peakLen, &peakVal, &peak);
             peak += m;
             peakDelay = numPeaks > 0 ? peak - peaks[numPeaks - 1] : minPeakDelay;
             if (peakLen >= minPeakWidth && peakDelay >= minPeakDelay)
@@ -84,6 +92,128 @@ pk_ppg_find_peaks_f32(ppg_peak_f32_t *ctx, float32_t *ppg, uint32_t ppgLen, uint
     return numPeaks;
 }
 
+uint32_t
+pk_ppg_peak_stream_state_size_f32(ppg_peak_stream_f32_t *ctx)
+{
+    uint32_t maPeakLen = (uint32_t)(ctx->sampleRate * ctx->peakWin + 1);
+    uint32_t maBeatLen = (uint32_t)(ctx->sampleRate * ctx->beatWin + 1);
+    return maPeakLen + 2 * maBeatLen + PK_PPG_STREAM_CHUNK + 1;
+}
+
+uint32_t
+pk_ppg_init_peak_stream_f32(ppg_peak_stream_f32_t *ctx)
+{
+    uint32_t maPeakLen = (uint32_t)(ctx->sampleRate * ctx->peakWin + 1);
+    uint32_t maBeatLen = (uint32_t)(ctx->sampleRate * ctx->beatWin + 1);
+    uint32_t peakDelay = maPeakLen - 1 - maPeakLen / 2;
+
+    ctx->peakAvg.windowSize = maPeakLen;
+    ctx->peakAvg.buffer = &ctx->state[0];
+    ctx->beatAvg.windowSize = maBeatLen;
+    ctx->beatAvg.buffer = &ctx->state[maPeakLen];
+    ctx->sqrdBuf = &ctx->state[maPeakLen + maBeatLen];
+    ctx->sqrdBufLen = maBeatLen + PK_PPG_STREAM_CHUNK + 1;
+    arm_fill_f32(0, ctx->sqrdBuf, ctx->sqrdBufLen);
+    pk_init_moving_average_f32(&ctx->peakAvg);
+    pk_init_moving_average_f32(&ctx->beatAvg);
+
+    // Delay peak average input so both averages are centered on the same sample
+    ctx->beatDelay = maBeatLen - 1 - maBeatLen / 2;
+    ctx->peakLag = ctx->beatDelay > peakDelay ? ctx->beatDelay - peakDelay : 0;
+    ctx->minPeakDelay = (uint32_t)(ctx->sampleRate * ctx->peakDelayWin + 1);
+    ctx->minPeakWidth = maPeakLen;
+    ctx->muSqrd = 0;
+    ctx->muAlpha = 1.0f / (ctx->sampleRate * ctx->meanWin + 1);
+    ctx->prevDiff = 0;
+    ctx->numSamples = 0;
+    ctx->inPeak = 0;
+    ctx->peakStart = 0;
+    ctx->peakVal = 0;
+    ctx->peakIdx = 0;
+    ctx->hasPeak = 0;
+    ctx->lastPeak = 0;
+    return 0;
+}
+
+uint32_t
+pk_ppg_find_peaks_stream_f32(ppg_peak_stream_f32_t *ctx, float32_t *ppg, uint32_t blockSize, uint32_t *peaks)
+{
+    float32_t maPeak[PK_PPG_STREAM_CHUNK];
+    float32_t maBeat[PK_PPG_STREAM_CHUNK];
+    float32_t muSqrd[PK_PPG_STREAM_CHUNK];
+    uint32_t numPeaks = 0;
+    uint32_t n, idx, peakDelay, peakLen;
+    float32_t sqrd, diff, sqrdVal;
+
+    for (size_t offset = 0; offset < blockSize; offset += PK_PPG_STREAM_CHUNK)
+    {
+        uint32_t chunkLen = blockSize - offset < PK_PPG_STREAM_CHUNK ? blockSize - offset : PK_PPG_STREAM_CHUNK;
+        uint32_t chunkStart = ctx->numSamples;
+
+        // Compute squared signal and running mean
+        for (size_t i = 0; i < chunkLen; i++)
+        {
+            n = chunkStart + i;
+            sqrd = ppg[offset + i] > 0 ? ppg[offset + i] * ppg[offset + i] : 0;
+            ctx->sqrdBuf[n % ctx->sqrdBufLen] = sqrd;
+            maBeat[i] = sqrd;
+            maPeak[i] = n >= ctx->peakLag ? ctx->sqrdBuf[(n - ctx->peakLag) % ctx->sqrdBufLen] : 0;
+            // Cumulative mean during warm-up then exponential
+            ctx->muSqrd += (sqrd - ctx->muSqrd) * (n * ctx->muAlpha < 1.0f ? 1.0f / (n + 1) : ctx->muAlpha);
+            muSqrd[i] = ctx->muSqrd * ctx->beatOffset;
+        }
+        ctx->numSamples += chunkLen;
+
+        // Apply peak and beat moving averages
+        pk_apply_moving_average_f32(&ctx->peakAvg, maPeak, maPeak, chunkLen);
+        pk_apply_moving_average_f32(&ctx->beatAvg, maBeat, maBeat, chunkLen);
+
+        for (size_t i = 0; i < chunkLen; i++)
+        {
+            n = chunkStart + i;
+            // Wait for beat window to fill before thresholding
+            if (n < ctx->beatAvg.windowSize)
+            {
+                continue;
+            }
+            idx = n - ctx->beatDelay;
+            diff = maPeak[i] - (maBeat[i] + muSqrd[i]);
+            sqrdVal = ctx->sqrdBuf[idx % ctx->sqrdBufLen];
+            if (ctx->prevDiff <= 0 && diff > 0)
+            {
+                // Rising edge
+                ctx->inPeak = 1;
+                ctx->peakStart = idx;
+                ctx->peakVal = sqrdVal;
+                ctx->peakIdx = idx;
+            }
+            else if (ctx->inPeak)
+            {
+                if (sqrdVal > ctx->peakVal)
+                {
+                    ctx->peakVal = sqrdVal;
+                    ctx->peakIdx = idx;
+                }
+                // Falling edge
+                if (ctx->prevDiff > 0 && diff <= 0)
+                {
+                    peakLen = idx - ctx->peakStart + 1;
+                    peakDelay = ctx->hasPeak ? ctx->peakIdx - ctx->lastPeak : ctx->minPeakDelay;
+                    if (peakLen >= ctx->minPeakWidth && peakDelay >= ctx->minPeakDelay)
+                    {
+                        peaks[numPeaks++] = ctx->peakIdx;
+                        ctx->lastPeak = ctx->peakIdx;
+                        ctx->hasPeak = 1;
+                    }
+                    ctx->inPeak = 0;
+                }
+            }
+            ctx->prevDiff = diff;
+        }
+    }
+    return numPeaks;
+}
+
 uint32_t
 pk_ppg_compute_rr_intervals(uint32_t *peaks, uint32_t numPeaks, uint32_t *rrIntervals)
 {
@@ -154,8 +284,8 @@ pk_ppg_compute_spo2_in_time_f32(float32_t *ppg1, float32_t *ppg2, float32_t ppg1
     // Assume signals are already filtered
 
     // Compute AC via RMS
-    arm_rms_f32(ppg1, blockSize, &ppg1Ac);
-    arm_rms_f32(ppg2, blockSize, &ppg2Ac);
+    pk_rms_f32(ppg1, &ppg1Ac, blockSize);
+    pk_rms_f32(ppg2, &ppg2Ac, blockSize);
 
     // Compute SpO2
     spo2 = pk_ppg_compute_spo2_from_perfusion_f32(ppg1Dc, ppg1Ac, ppg2Dc, ppg2Ac, coefs);
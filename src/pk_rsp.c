@@ -11,10 +11,18 @@
 #include <stdint.h>
 #include "arm_math.h"
 
+#include "pk_dsp.h"
 #include "pk_math.h"
 #include "pk_filter.h"
 #include "pk_rsp.h"
 
+uint32_t
+pk_rsp_peak_state_size_f32(rsp_peak_f32_t *ctx, uint32_t rspLen)
+{
+    // Peak and breath moving averages and squared signal
+    return 3 * rspLen;
+}
+
 uint32_t
 pk_rsp_find_peaks_f32(rsp_peak_f32_t *ctx, float32_t *rsp, uint32_t rspLen, uint32_t *peaks)
 {
@@ -29,7 +37,6 @@ pk_rsp_find_peaks_f32(rsp_peak_f32_t *ctx, float32_t *rsp, uint32_t rspLen, uint
     float32_t *maPeak = &ctx->state[0 * rspLen];
     float32_t *maBeat = &ctx->state[1 * rspLen];
     float32_t *sqrd = &ctx->state[2 * rspLen];
-    float32_t *wBuffer = &ctx->state[3 * rspLen];
 
     // Compute squared signal
     for (size_t i = 0; i < rspLen; i++)
@@ -40,14 +47,15 @@ pk_rsp_find_peaks_f32(rsp_peak_f32_t *ctx, float32_t *rsp, uint32_t rspLen, uint
     pk_mean_f32(sqrd, &muSqrd, rspLen);
     muSqrd = muSqrd * ctx->breathOffset;
 
-    // Apply peak moving average
-    pk_smooth_signal_f32(sqrd, maPeak, rspLen, wBuffer, maPeakLen);
-
-    // Apply beat moving average
-    pk_smooth_signal_f32(sqrd, maBeat, rspLen, wBuffer, maBeatLen);
-    arm_offset_f32(maBeat, muSqrd, maBeat, rspLen);
+    // Apply peak and beat moving averages (signal shorter than a window has no peaks)
+    if (pk_smooth_signal_f32(sqrd, maPeak, rspLen, NULL, maPeakLen) != 0 ||
+        pk_smooth_signal_f32(sqrd, maBeat, rspLen, NULL, maBeatLen) != 0)
+    {
+        return 0;
+    }
+    pk_dsp_offset_f32(maBeat, muSqrd, maBeat, rspLen);
 
-    arm_sub_f32(maPeak, maBeat, maPeak, rspLen);
+    pk_dsp_sub_f32(maPeak, maBeat, maPeak, rspLen);
 
     uint32_t riseEdge, fallEdge, peakDelay, peakLen, peak;
     float32_t peakVal;
@@ -69,7 +77,7 @@ pk_rsp_find_peaks_f32(rsp_peak_f32_t *ctx, float32_t *rsp, uint32_t rspLen, uint
         if (m != -1 && n != -1)
         {
             peakLen = n - m + 1;
-            arm_max_f32(&rsp[m], peakLen, &peakVal, &peak);
+            pk_dsp_max_f32(&rsp[m], peakLen, &peakVal, &peak);
             peak += m;
             peakDelay = numPeaks > 0 ? peak - peaks[numPeaks - 1] : minPeakDelay;
             if (peakLen >= minPeakWidth && peakDelay >= minPeakDelay)
@@ -83,6 +91,159 @@ pk_rsp_find_peaks_f32(rsp_peak_f32_t *ctx, float32_t *rsp, uint32_t rspLen, uint
     return numPeaks;
 }
 
+uint32_t
+pk_rsp_peak_stream_state_size_f32(rsp_peak_stream_f32_t *ctx)
+{
+    uint32_t maPeakLen = (uint32_t)(ctx->sampleRate * ctx->peakWin + 1);
+    uint32_t maBeatLen = (uint32_t)(ctx->sampleRate * ctx->breathWin + 1);
+    return maPeakLen + maBeatLen + 2 * (maBeatLen + PK_RSP_STREAM_CHUNK + 1);
+}
+
+uint32_t
+pk_rsp_init_peak_stream_f32(rsp_peak_stream_f32_t *ctx)
+{
+    uint32_t maPeakLen = (uint32_t)(ctx->sampleRate * ctx->peakWin + 1);
+    uint32_t maBeatLen = (uint32_t)(ctx->sampleRate * ctx->breathWin + 1);
+    uint32_t peakDelay = maPeakLen - 1 - maPeakLen / 2;
+
+    ctx->peakAvg.windowSize = maPeakLen;
+    ctx->peakAvg.buffer = &ctx->state[0];
+    ctx->breathAvg.windowSize = maBeatLen;
+    ctx->breathAvg.buffer = &ctx->state[maPeakLen];
+    ctx->bufLen = maBeatLen + PK_RSP_STREAM_CHUNK + 1;
+    ctx->sqrdBuf = &ctx->state[maPeakLen + maBeatLen];
+    ctx->rspBuf = &ctx->state[maPeakLen + maBeatLen + ctx->bufLen];
+    arm_fill_f32(0, ctx->sqrdBuf, 2 * ctx->bufLen);
+    pk_init_moving_average_f32(&ctx->peakAvg);
+    pk_init_moving_average_f32(&ctx->breathAvg);
+
+    // Delay peak average input so both averages are centered on the same sample
+    ctx->breathDelay = maBeatLen - 1 - maBeatLen / 2;
+    ctx->peakLag = ctx->breathDelay > peakDelay ? ctx->breathDelay - peakDelay : 0;
+    ctx->minPeakDelay = (uint32_t)(ctx->sampleRate * ctx->peakDelayWin + 1);
+    ctx->minPeakWidth = maPeakLen;
+    ctx->muSqrd = 0;
+    ctx->muAlpha = 1.0f / (ctx->sampleRate * ctx->meanWin + 1);
+    ctx->prevDiff = 0;
+    ctx->numSamples = 0;
+    ctx->inPeak = 0;
+    ctx->peakStart = 0;
+    ctx->peakVal = 0;
+    ctx->peakIdx = 0;
+    ctx->hasPeak = 0;
+    ctx->lastPeak = 0;
+    arm_fill_f32(0, ctx->rates, PK_RSP_STREAM_RATE_LEN);
+    ctx->rateIdx = 0;
+    ctx->numRates = 0;
+    ctx->rateSum = 0;
+    ctx->respRateBpm = 0;
+    return 0;
+}
+
+uint32_t
+pk_rsp_find_peaks_stream_f32(rsp_peak_stream_f32_t *ctx, float32_t *rsp, uint32_t blockSize, uint32_t *peaks, uint32_t *rrIntervals)
+{
+    float32_t maPeak[PK_RSP_STREAM_CHUNK];
+    float32_t maBeat[PK_RSP_STREAM_CHUNK];
+    float32_t muSqrd[PK_RSP_STREAM_CHUNK];
+    uint32_t numPeaks = 0;
+    uint32_t n, idx, peakDelay, peakLen, interval;
+    float32_t sqrd, diff, rspVal, rate;
+
+    for (size_t offset = 0; offset < blockSize; offset += PK_RSP_STREAM_CHUNK)
+    {
+        uint32_t chunkLen = blockSize - offset < PK_RSP_STREAM_CHUNK ? blockSize - offset : PK_RSP_STREAM_CHUNK;
+        uint32_t chunkStart = ctx->numSamples;
+
+        // Compute squared signal and running mean
+        for (size_t i = 0; i < chunkLen; i++)
+        {
+            n = chunkStart + i;
+            sqrd = rsp[offset + i] > 0 ? rsp[offset + i] * rsp[offset + i] : 0;
+            ctx->sqrdBuf[n % ctx->bufLen] = sqrd;
+            ctx->rspBuf[n % ctx->bufLen] = rsp[offset + i];
+            maBeat[i] = sqrd;
+            maPeak[i] = n >= ctx->peakLag ? ctx->sqrdBuf[(n - ctx->peakLag) % ctx->bufLen] : 0;
+            // Cumulative mean during warm-up then exponential
+            ctx->muSqrd += (sqrd - ctx->muSqrd) * (n * ctx->muAlpha < 1.0f ? 1.0f / (n + 1) : ctx->muAlpha);
+            muSqrd[i] = ctx->muSqrd * ctx->breathOffset;
+        }
+        ctx->numSamples += chunkLen;
+
+        // Apply peak and breath moving averages
+        pk_apply_moving_average_f32(&ctx->peakAvg, maPeak, maPeak, chunkLen);
+        pk_apply_moving_average_f32(&ctx->breathAvg, maBeat, maBeat, chunkLen);
+
+        for (size_t i = 0; i < chunkLen; i++)
+        {
+            n = chunkStart + i;
+            // Wait for breath window to fill before thresholding
+            if (n < ctx->breathAvg.windowSize)
+            {
+                continue;
+            }
+            idx = n - ctx->breathDelay;
+            diff = maPeak[i] - (maBeat[i] + muSqrd[i]);
+            rspVal = ctx->rspBuf[idx % ctx->bufLen];
+            if (ctx->prevDiff <= 0 && diff > 0)
+            {
+                // Rising edge
+                ctx->inPeak = 1;
+                ctx->peakStart = idx;
+                ctx->peakVal = rspVal;
+                ctx->peakIdx = idx;
+            }
+            else if (ctx->inPeak)
+            {
+                if (rspVal > ctx->peakVal)
+                {
+                    ctx->peakVal = rspVal;
+                    ctx->peakIdx = idx;
+                }
+                // Falling edge
+                if (ctx->prevDiff > 0 && diff <= 0)
+                {
+                    peakLen = idx - ctx->peakStart + 1;
+                    peakDelay = ctx->hasPeak ? ctx->peakIdx - ctx->lastPeak : ctx->minPeakDelay;
+                    if (peakLen >= ctx->minPeakWidth && peakDelay >= ctx->minPeakDelay)
+                    {
+                        interval = ctx->hasPeak ? peakDelay : 0;
+                        if (interval > 0)
+                        {
+                            // Update running respiratory rate
+                            rate = 60.0f * ctx->sampleRate / interval;
+                            ctx->rateSum += rate - ctx->rates[ctx->rateIdx];
+                            ctx->rates[ctx->rateIdx] = rate;
+                            ctx->rateIdx = (ctx->rateIdx + 1) % PK_RSP_STREAM_RATE_LEN;
+                            ctx->numRates += ctx->numRates < PK_RSP_STREAM_RATE_LEN ? 1 : 0;
+                            if (ctx->rateIdx == 0)
+                            {
+                                // Recompute sum once per window to bound accumulated rounding error
+                                ctx->rateSum = 0;
+                                for (size_t r = 0; r < PK_RSP_STREAM_RATE_LEN; r++)
+                                {
+                                    ctx->rateSum += ctx->rates[r];
+                                }
+                            }
+                            ctx->respRateBpm = ctx->rateSum / ctx->numRates;
+                        }
+                        if (rrIntervals != NULL)
+                        {
+                            rrIntervals[numPeaks] = interval;
+                        }
+                        peaks[numPeaks++] = ctx->peakIdx;
+                        ctx->lastPeak = ctx->peakIdx;
+                        ctx->hasPeak = 1;
+                    }
+                    ctx->inPeak = 0;
+                }
+            }
+            ctx->prevDiff = diff;
+        }
+    }
+    return numPeaks;
+}
+
 uint32_t
 pk_rsp_compute_rr_intervals(uint32_t *peaks, uint32_t numPeaks, uint32_t *rrIntervals)
 {
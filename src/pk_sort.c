@@ -9,6 +9,7 @@
  *
  */
 
+#include <string.h>
 #include "arm_math.h"
 #include "pk_sort.h"
 
@@ -33,3 +34,360 @@ pk_binary_search_f32(float32_t *x, size_t xLen, float32_t xNew)
     }
     return low;
 }
+
+#define PK_RADIX_BINS (1U << PK_RADIX_BITS)
+#define PK_RADIX_MASK (PK_RADIX_BINS - 1)
+
+uint32_t
+pk_radix_sort_workspace_size(uint32_t len, uint8_t hasIndex)
+{
+    // Ping-pong buffer for keys (and payload)
+    return hasIndex ? 2 * len : len;
+}
+
+uint32_t
+pk_radix_sort_u32(uint32_t *keys, uint32_t *indices, uint32_t len, uint32_t *workspace)
+{
+    uint32_t count[PK_RADIX_BINS];
+    uint32_t *srcK = keys, *srcI = indices;
+    uint32_t *dstK = workspace, *dstI = indices != NULL ? &workspace[len] : NULL;
+    uint32_t *t;
+    uint32_t d, sum, c;
+    if (len < 2)
+    {
+        return 0;
+    }
+    for (uint32_t shift = 0; shift < 32; shift += PK_RADIX_BITS)
+    {
+        memset(count, 0, sizeof(count));
+        for (size_t i = 0; i < len; i++)
+        {
+            count[(srcK[i] >> shift) & PK_RADIX_MASK]++;
+        }
+        // Skip pass if every key has the same digit
+        if (count[(srcK[0] >> shift) & PK_RADIX_MASK] == len)
+        {
+            continue;
+        }
+        sum = 0;
+        for (size_t b = 0; b < PK_RADIX_BINS; b++)
+        {
+            c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+        if (srcI != NULL)
+        {
+            for (size_t i = 0; i < len; i++)
+            {
+                d = count[(srcK[i] >> shift) & PK_RADIX_MASK]++;
+                dstK[d] = srcK[i];
+                dstI[d] = srcI[i];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < len; i++)
+            {
+                dstK[count[(srcK[i] >> shift) & PK_RADIX_MASK]++] = srcK[i];
+            }
+        }
+        t = srcK, srcK = dstK, dstK = t;
+        t = srcI, srcI = dstI, dstI = t;
+    }
+    if (srcK != keys)
+    {
+        memcpy(keys, srcK, len * sizeof(uint32_t));
+        if (indices != NULL)
+        {
+            memcpy(indices, srcI, len * sizeof(uint32_t));
+        }
+    }
+    return 0;
+}
+
+static inline uint32_t
+pk_radix_key_f32(float32_t v)
+{
+    // Flip all bits of negatives and the sign bit of positives so unsigned order matches float order
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    return (u & 0x80000000U) ? ~u : (u | 0x80000000U);
+}
+
+static inline float32_t
+pk_radix_value_f32(uint32_t u)
+{
+    float32_t v;
+    u = (u & 0x80000000U) ? (u & 0x7FFFFFFFU) : ~u;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+uint32_t
+pk_radix_sort_workspace_size_f32(uint32_t len, uint8_t hasIndex)
+{
+    // Keys followed by radix sort workspace
+    return len + pk_radix_sort_workspace_size(len, hasIndex);
+}
+
+uint32_t
+pk_radix_sort_f32(float32_t *x, uint32_t *indices, uint32_t len, uint32_t *workspace)
+{
+    // Keys live in the workspace so x is never accessed through uint32_t
+    uint32_t *keys = workspace;
+    for (size_t i = 0; i < len; i++)
+    {
+        keys[i] = pk_radix_key_f32(x[i]);
+    }
+    pk_radix_sort_u32(keys, indices, len, &workspace[len]);
+    for (size_t i = 0; i < len; i++)
+    {
+        x[i] = pk_radix_value_f32(keys[i]);
+    }
+    return 0;
+}
+
+uint32_t
+pk_eytzinger_state_size_f32(uint32_t len)
+{
+    // Node 0 holds the "not found" result
+    return len + 1;
+}
+
+static void
+pk_eytzinger_build_f32(eytzinger_f32_t *ctx, const float32_t *x, uint32_t *i, uint32_t k)
+{
+    // In-order traversal of implicit tree assigns sorted values to nodes
+    if (k > ctx->len)
+    {
+        return;
+    }
+    pk_eytzinger_build_f32(ctx, x, i, 2 * k);
+    ctx->tree[k] = x[*i];
+    ctx->rank[k] = (*i)++;
+    pk_eytzinger_build_f32(ctx, x, i, 2 * k + 1);
+}
+
+uint32_t
+pk_init_eytzinger_f32(eytzinger_f32_t *ctx, const float32_t *x)
+{
+    uint32_t i = 0;
+    if (ctx->len >= 0x80000000U)
+    {
+        return 1;
+    }
+    // Node 0 is the "not found" result
+    ctx->tree[0] = 0;
+    ctx->rank[0] = ctx->len;
+    pk_eytzinger_build_f32(ctx, x, &i, 1);
+    ctx->levels = 0;
+    while ((1U << ctx->levels) <= ctx->len)
+    {
+        ctx->levels++;
+    }
+    return 0;
+}
+
+static inline uint32_t
+pk_eytzinger_step_f32(eytzinger_f32_t *ctx, uint32_t k, float32_t xNew)
+{
+    // Missing nodes (last level) descend right, which the final decode strips
+    uint32_t kk = k <= ctx->len ? k : 0;
+    return 2 * k + ((k > ctx->len) | (ctx->tree[kk] < xNew));
+}
+
+static inline uint32_t
+pk_eytzinger_rank_f32(eytzinger_f32_t *ctx, uint32_t k)
+{
+    // Drop trailing right turns and the last left turn to get the answer node
+    k >>= __builtin_ctz(~k) + 1;
+    return ctx->rank[k];
+}
+
+uint32_t
+pk_eytzinger_lower_bound_f32(eytzinger_f32_t *ctx, float32_t xNew)
+{
+    uint32_t k = 1;
+    for (size_t l = 0; l < ctx->levels; l++)
+    {
+        k = pk_eytzinger_step_f32(ctx, k, xNew);
+    }
+    return pk_eytzinger_rank_f32(ctx, k);
+}
+
+uint32_t
+pk_eytzinger_lower_bound_batch_f32(eytzinger_f32_t *ctx, const float32_t *xNew, uint32_t *idx, uint32_t numQueries)
+{
+    uint32_t k[PK_EYTZINGER_GROUP];
+    size_t n;
+    for (size_t q = 0; q < numQueries; q += PK_EYTZINGER_GROUP)
+    {
+        n = numQueries - q < PK_EYTZINGER_GROUP ? numQueries - q : PK_EYTZINGER_GROUP;
+        for (size_t j = 0; j < n; j++)
+        {
+            k[j] = 1;
+        }
+        for (size_t l = 0; l < ctx->levels; l++)
+        {
+            for (size_t j = 0; j < n; j++)
+            {
+                k[j] = pk_eytzinger_step_f32(ctx, k[j], xNew[q + j]);
+            }
+        }
+        for (size_t j = 0; j < n; j++)
+        {
+            idx[q + j] = pk_eytzinger_rank_f32(ctx, k[j]);
+        }
+    }
+    return 0;
+}
+
+#define PK_SELECT_INSERTION_LEN (16)
+
+static void
+pk_insertion_sort_f32(float32_t *x, size_t xLen)
+{
+    for (size_t i = 1; i < xLen; i++)
+    {
+        float32_t v = x[i];
+        size_t j = i;
+        while (j > 0 && x[j - 1] > v)
+        {
+            x[j] = x[j - 1];
+            j--;
+        }
+        x[j] = v;
+    }
+}
+
+static void
+pk_sift_down_f32(float32_t *x, size_t root, size_t xLen)
+{
+    float32_t v = x[root];
+    size_t child;
+    while ((child = 2 * root + 1) < xLen)
+    {
+        if (child + 1 < xLen && x[child + 1] > x[child])
+        {
+            child++;
+        }
+        if (x[child] <= v)
+        {
+            break;
+        }
+        x[root] = x[child];
+        root = child;
+    }
+    x[root] = v;
+}
+
+static void
+pk_heap_sort_f32(float32_t *x, size_t xLen)
+{
+    for (size_t i = xLen / 2; i-- > 0;)
+    {
+        pk_sift_down_f32(x, i, xLen);
+    }
+    for (size_t i = xLen; i-- > 1;)
+    {
+        float32_t t = x[0];
+        x[0] = x[i];
+        x[i] = t;
+        pk_sift_down_f32(x, 0, i);
+    }
+}
+
+static void
+pk_multiselect_range_f32(float32_t *x, size_t lo, size_t hi, const size_t *ranks, size_t numRanks, uint32_t depth)
+{
+    // Select ranks within x[lo..hi)
+    while (numRanks > 0)
+    {
+        size_t len = hi - lo;
+        if (len <= PK_SELECT_INSERTION_LEN)
+        {
+            pk_insertion_sort_f32(&x[lo], len);
+            return;
+        }
+        if (depth == 0)
+        {
+            // Degenerate pivots- bound worst case
+            pk_heap_sort_f32(&x[lo], len);
+            return;
+        }
+        depth--;
+
+        // Median of three pivot
+        float32_t a = x[lo], b = x[lo + len / 2], c = x[hi - 1];
+        float32_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+        // Three-way partition: [lo, lt) < pivot, [lt, gt) == pivot, [gt, hi) > pivot
+        // RR intervals are integer ticks so duplicates are common.
+        size_t lt = lo, i = lo, gt = hi;
+        while (i < gt)
+        {
+            float32_t v = x[i];
+            if (v < pivot)
+            {
+                x[i++] = x[lt];
+                x[lt++] = v;
+            }
+            else if (v > pivot)
+            {
+                x[i] = x[--gt];
+                x[gt] = v;
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        // Split ranks between partitions (ranks in [lt, gt) are done)
+        size_t numLeft = 0;
+        while (numLeft < numRanks && ranks[numLeft] < lt)
+        {
+            numLeft++;
+        }
+        size_t rightIdx = numLeft;
+        while (rightIdx < numRanks && ranks[rightIdx] < gt)
+        {
+            rightIdx++;
+        }
+        if (numLeft > 0)
+        {
+            pk_multiselect_range_f32(x, lo, lt, ranks, numLeft, depth);
+        }
+        ranks += rightIdx;
+        numRanks -= rightIdx;
+        lo = gt;
+    }
+}
+
+uint32_t
+pk_multiselect_f32(float32_t *x, size_t xLen, const size_t *ranks, size_t numRanks)
+{
+    if (numRanks == 0)
+    {
+        return 0;
+    }
+    if (ranks[numRanks - 1] >= xLen)
+    {
+        return 1;
+    }
+    uint32_t depth = 0;
+    for (size_t n = xLen; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+    pk_multiselect_range_f32(x, 0, xLen, ranks, numRanks, depth);
+    return 0;
+}
+
+float32_t
+pk_select_f32(float32_t *x, size_t xLen, size_t k)
+{
+    pk_multiselect_f32(x, xLen, &k, 1);
+    return x[k];
+}